@@ -0,0 +1,148 @@
+#include "AI/PhysicsBotController.h"
+#include "PhysicsCharacter.h"
+#include "Weapons/WeaponInventoryComponent.h"
+#include "InputActionValue.h"
+#include "Engine/World.h"
+
+APhysicsBotController::APhysicsBotController()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	bWantsPlayerState = false;
+}
+
+void APhysicsBotController::OnPossess(APawn* InPawn)
+{
+	Super::OnPossess(InPawn);
+
+	m_Character = Cast<APhysicsCharacter>(InPawn);
+	if (!m_Character)
+	{
+		return;
+	}
+
+	for (const TSubclassOf<AActor>& WeaponClass : m_WeaponClasses)
+	{
+		m_Character->GetWeaponInventory()->AddWeaponFromClass(WeaponClass);
+	}
+}
+
+void APhysicsBotController::OnUnPossess()
+{
+	if (m_Character)
+	{
+		SetGrabbing(false);
+		m_Character->SetIsSprinting(false);
+		m_Character->GetWeaponInventory()->SetTriggerHeld(false);
+	}
+	m_Character = nullptr;
+
+	Super::OnUnPossess();
+}
+
+void APhysicsBotController::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (!m_Character)
+	{
+		return;
+	}
+
+	m_TimeToDecision -= DeltaSeconds;
+	if (m_TimeToDecision <= 0.f)
+	{
+		Decide();
+		m_TimeToDecision += m_DecisionInterval;
+	}
+
+	// Held inputs are fed every frame, same as ETriggerEvent::Triggered does for the player
+	m_Character->Move(FInputActionValue(m_MoveInput));
+	m_Character->Sprint(FInputActionValue(m_bSprinting));
+
+	// AddControllerYawInput only reaches player controllers, so look input is applied to the control rotation here
+	FRotator ControlRotation = GetControlRotation();
+	ControlRotation.Yaw += m_LookInput.X * DeltaSeconds;
+	ControlRotation.Pitch = FMath::ClampAngle(ControlRotation.Pitch + m_LookInput.Y * DeltaSeconds, -60.f, 60.f);
+	SetControlRotation(ControlRotation);
+
+	if (m_bGrabbing)
+	{
+		m_Character->GrabObject(FInputActionValue(true));
+	}
+
+	m_Character->GetWeaponInventory()->SetTriggerHeld(m_bFiring);
+}
+
+void APhysicsBotController::Decide()
+{
+	switch (m_Behaviour)
+	{
+	case EBotBehaviour::SCRIPTED:
+		DecideScripted();
+		break;
+	case EBotBehaviour::RANDOM:
+	default:
+		DecideRandom();
+		break;
+	}
+}
+
+void APhysicsBotController::DecideScripted()
+{
+	// Walk, sprint, turn while grabbing, then fire, so every entry point is exercised once per loop
+	switch (m_ScriptStep)
+	{
+	case 0:
+		m_MoveInput = FVector2D(0.f, 1.f);
+		m_LookInput = FVector2D::ZeroVector;
+		m_bSprinting = false;
+		m_bFiring = false;
+		break;
+	case 1:
+		m_MoveInput = FVector2D(0.f, 1.f);
+		m_bSprinting = true;
+		break;
+	case 2:
+		m_MoveInput = FVector2D(1.f, 0.f);
+		m_bSprinting = false;
+		m_LookInput = FVector2D(90.f, 0.f);
+		SetGrabbing(true);
+		break;
+	case 3:
+		m_MoveInput = FVector2D::ZeroVector;
+		m_LookInput = FVector2D(-90.f, 0.f);
+		SetGrabbing(false);
+		m_bFiring = true;
+		m_Character->GetWeaponInventory()->NextWeapon();
+		break;
+	default:
+		break;
+	}
+	m_ScriptStep = (m_ScriptStep + 1) % 4;
+}
+
+void APhysicsBotController::DecideRandom()
+{
+	m_MoveInput = FVector2D(m_Random.FRandRange(-1.f, 1.f), m_Random.FRandRange(-1.f, 1.f));
+	m_LookInput = FVector2D(m_Random.FRandRange(-180.f, 180.f), m_Random.FRandRange(-30.f, 30.f));
+	m_bSprinting = m_Random.FRand() < 0.3f;
+	m_bFiring = m_Random.FRand() < 0.4f;
+	SetGrabbing(m_Random.FRand() < 0.25f);
+	if (m_Random.FRand() < 0.2f)
+	{
+		m_Character->GetWeaponInventory()->NextWeapon();
+	}
+}
+
+void APhysicsBotController::SetGrabbing(bool bGrab)
+{
+	if (!m_bGrabbing && bGrab)
+	{
+		m_Character->BeginGrabInput(FInputActionValue(true));
+	}
+	if (m_bGrabbing && !bGrab)
+	{
+		m_Character->ReleaseObject(FInputActionValue(false));
+	}
+	m_bGrabbing = bGrab;
+}
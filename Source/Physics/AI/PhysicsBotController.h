@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "PhysicsBotController.generated.h"
+
+class APhysicsCharacter;
+
+UENUM(BlueprintType)
+enum class EBotBehaviour : uint8
+{
+	/** Fixed loop of move, sprint, look, grab and fire phases */
+	SCRIPTED,
+	/** New random action every decision interval, drawn from the bot seed */
+	RANDOM
+};
+
+/**
+ * Drives an APhysicsCharacter through the same entry points the player input uses
+ * (Move, Look, Sprint, GrabObject/ReleaseObject and the inventory trigger and weapon swaps), used to load the module with many characters.
+ */
+UCLASS(config=Game)
+class PHYSICS_API APhysicsBotController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Bot)
+	EBotBehaviour m_Behaviour = EBotBehaviour::RANDOM;
+
+	/** Seconds between two decisions */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Bot)
+	float m_DecisionInterval = 0.5f;
+
+	/** Pickup actors spawned into the character inventory when possessed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Bot)
+	TArray<TSubclassOf<AActor>> m_WeaponClasses;
+
+	APhysicsBotController();
+
+	/** Sets the seed of the bot random stream, call before possessing for reproducible runs */
+	void SetSeed(int32 Seed) { m_Random.Initialize(Seed); }
+
+	virtual void Tick(float DeltaSeconds) override;
+
+protected:
+	virtual void OnPossess(APawn* InPawn) override;
+	virtual void OnUnPossess() override;
+
+	void Decide();
+	void DecideScripted();
+	void DecideRandom();
+
+	void SetGrabbing(bool bGrab);
+
+	UPROPERTY()
+	APhysicsCharacter* m_Character;
+
+	FRandomStream m_Random;
+
+	FVector2D m_MoveInput = FVector2D::ZeroVector;
+	FVector2D m_LookInput = FVector2D::ZeroVector;
+	bool m_bSprinting = false;
+	bool m_bGrabbing = false;
+	bool m_bFiring = false;
+
+	float m_TimeToDecision = 0.f;
+	int32 m_ScriptStep = 0;
+};
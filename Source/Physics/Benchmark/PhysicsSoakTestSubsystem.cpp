@@ -0,0 +1,361 @@
+#include "Benchmark/PhysicsSoakTestSubsystem.h"
+#include "AI/PhysicsBotController.h"
+#include "Benchmark/PhysicsStressSpawner.h"
+#include "BreakableTarget.h"
+#include "PhysicsCharacter.h"
+#include "Weapons/WeaponInventoryComponent.h"
+#include "Simulation/PhysicsDeterminism.h"
+#include "Telemetry/CombatTelemetry.h"
+#include "Profiling/PhysicsHitchDetector.h"
+#include "Profiling/PhysicsLatencyTracker.h"
+#include "PhysicsCosmetics.h"
+#include "Simulation/DebrisCollisionFilterSubsystem.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PBDRigidsSolver.h"
+#include "Chaos/SimCallbackObject.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerStart.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include <atomic>
+
+DEFINE_LOG_CATEGORY_STATIC(LogPhysicsSoak, Log, All);
+
+/** Collision pairs left by the previous step, read at the start of every step on the physics thread */
+class FSoakCollisionPairsCallback : public Chaos::TSimCallbackObject<>
+{
+public:
+	std::atomic<int32> BroadphasePairs{ 0 };
+	std::atomic<int32> NarrowphasePairs{ 0 };
+
+private:
+	virtual void OnPreSimulate_Internal() override
+	{
+		const Chaos::FPBDCollisionConstraints& Collisions = static_cast<Chaos::FPBDRigidsSolver*>(GetSolver())->GetEvolution()->GetCollisionConstraints();
+		BroadphasePairs.store(Collisions.GetConstraintAllocator().GetNumMidPhases(), std::memory_order_relaxed);
+		NarrowphasePairs.store(Collisions.NumConstraints(), std::memory_order_relaxed);
+	}
+};
+
+bool UPhysicsSoakTestSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!FParse::Param(FCommandLine::Get(), TEXT("PhysicsSoak")))
+	{
+		return false;
+	}
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UPhysicsSoakTestSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (FPhysicsDeterminism::IsEnabled())
+	{
+		m_Seed = FPhysicsDeterminism::GetSessionSeed();
+	}
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	FParse::Value(CommandLine, TEXT("SoakBots="), m_NumBots);
+	FParse::Value(CommandLine, TEXT("SoakDuration="), m_Duration);
+	FParse::Value(CommandLine, TEXT("SoakHitchMs="), m_HitchThresholdMs);
+	FParse::Value(CommandLine, TEXT("SoakSeed="), m_Seed);
+}
+
+void UPhysicsSoakTestSubsystem::Deinitialize()
+{
+	if (m_CollisionPairs)
+	{
+		if (Chaos::FPBDRigidsSolver* Solver = static_cast<Chaos::FPBDRigidsSolver*>(m_CollisionPairs->GetSolver()))
+		{
+			Solver->UnregisterAndFreeSimCallbackObject_External(m_CollisionPairs);
+		}
+		m_CollisionPairs = nullptr;
+	}
+
+	Super::Deinitialize();
+}
+
+void UPhysicsSoakTestSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	FPhysScene* PhysScene = InWorld.GetPhysicsScene();
+	if (Chaos::FPBDRigidsSolver* Solver = PhysScene ? PhysScene->GetSolver() : nullptr)
+	{
+		m_CollisionPairs = Solver->CreateAndRegisterSimCallbackObject_External<FSoakCollisionPairsCallback>();
+	}
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("PhysicsStress")))
+	{
+		SpawnStressLayout(InWorld);
+	}
+	SpawnBots(InWorld);
+
+	// Roughly one sample per frame at 120 FPS, so the measurement itself does not allocate
+	m_FrameTimesMs.Reset();
+	m_FrameTimesMs.Reserve(FMath::CeilToInt(m_Duration * 120.f));
+	m_ElapsedTime = 0.0;
+	m_LastFrameTime = 0.0;
+	m_HitchCount = 0;
+	m_UsedPhysicalHighWater = 0;
+	m_UsedVirtualHighWater = 0;
+	m_bRunning = true;
+
+	UE_LOG(LogPhysicsSoak, Display, TEXT("Soak started: %d bots, %.0fs, seed %d"), m_Bots.Num(), m_Duration, m_Seed);
+}
+
+FVector UPhysicsSoakTestSubsystem::GetSpawnOrigin(UWorld& World) const
+{
+	for (TActorIterator<APlayerStart> It(&World); It; ++It)
+	{
+		return It->GetActorLocation();
+	}
+	return FVector::ZeroVector;
+}
+
+void UPhysicsSoakTestSubsystem::SpawnStressLayout(UWorld& World)
+{
+	// Next to the bot grid rather than on top of it
+	const int32 Side = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(m_NumBots)));
+	const FVector Origin = GetSpawnOrigin(World) + FVector((Side / 2 + 2) * m_SpawnSpacing + m_StressLayoutOffset, 0.f, 0.f);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.bDeferConstruction = true;
+	APhysicsStressSpawner* Spawner = World.SpawnActor<APhysicsStressSpawner>(Origin, FRotator::ZeroRotator, SpawnParams);
+	Spawner->m_Layout.m_Seed = m_Seed;
+	Spawner->m_Layout.ParseCommandLine(FCommandLine::Get());
+	Spawner->m_bSpawnOnBeginPlay = false;
+	Spawner->FinishSpawning(FTransform(Origin));
+	m_StressItems = Spawner->SpawnLayout();
+}
+
+void UPhysicsSoakTestSubsystem::SpawnBots(UWorld& World)
+{
+	const AGameModeBase* GameMode = World.GetAuthGameMode();
+	if (!GameMode || !GameMode->DefaultPawnClass)
+	{
+		UE_LOG(LogPhysicsSoak, Error, TEXT("Soak test needs a game mode with a default pawn class"));
+		return;
+	}
+
+	const FVector Origin = GetSpawnOrigin(World);
+
+	TArray<TSubclassOf<AActor>> WeaponClasses;
+	for (const TSoftClassPtr<AActor>& WeaponClass : m_BotWeaponClasses)
+	{
+		if (UClass* Loaded = WeaponClass.LoadSynchronous())
+		{
+			WeaponClasses.Add(Loaded);
+		}
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	// Square grid centred on the player start
+	const int32 Side = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(m_NumBots)));
+	for (int32 i = 0; i < m_NumBots; ++i)
+	{
+		const FVector Offset((i % Side - Side / 2) * m_SpawnSpacing, (i / Side - Side / 2) * m_SpawnSpacing, 0.f);
+		APawn* Pawn = World.SpawnActor<APawn>(GameMode->DefaultPawnClass, Origin + Offset, FRotator::ZeroRotator, SpawnParams);
+		if (!Cast<APhysicsCharacter>(Pawn))
+		{
+			UE_LOG(LogPhysicsSoak, Error, TEXT("Default pawn class %s is not an APhysicsCharacter"), *GetNameSafe(GameMode->DefaultPawnClass));
+			if (Pawn)
+			{
+				Pawn->Destroy();
+			}
+			return;
+		}
+
+		APhysicsBotController* Bot = World.SpawnActor<APhysicsBotController>();
+		Bot->SetSeed(m_Seed + i);
+		Bot->m_WeaponClasses = WeaponClasses;
+		Bot->Possess(Pawn);
+		m_Bots.Add(Bot);
+	}
+}
+
+void UPhysicsSoakTestSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	m_ElapsedTime += DeltaTime;
+	if (m_ElapsedTime < m_WarmupDuration)
+	{
+		return;
+	}
+
+	// Wall clock, the world delta time is FPhysicsDeterminism::GetFixedDeltaTime() in deterministic mode
+	const double Now = FPlatformTime::Seconds();
+	const float FrameMs = m_LastFrameTime > 0.0 ? static_cast<float>((Now - m_LastFrameTime) * 1000.0) : 0.f;
+	m_LastFrameTime = Now;
+	if (FrameMs <= 0.f)
+	{
+		return;
+	}
+
+	m_FrameTimesMs.Add(FrameMs);
+	if (FrameMs > m_HitchThresholdMs)
+	{
+		++m_HitchCount;
+	}
+
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+	m_UsedPhysicalHighWater = FMath::Max<uint64>(m_UsedPhysicalHighWater, MemoryStats.UsedPhysical);
+	m_UsedVirtualHighWater = FMath::Max<uint64>(m_UsedVirtualHighWater, MemoryStats.UsedVirtual);
+	// Relative to one core, CPUTimePct is a share of the whole machine and would shrink on a bigger one
+	m_CpuPctSum += FPlatformTime::GetCPUTime().CPUTimePctRelative;
+
+	// The solver may be stepping on the physics thread right now, the counts come from the callback instead of the evolution
+	if (m_CollisionPairs)
+	{
+		const int32 BroadphasePairs = m_CollisionPairs->BroadphasePairs.load(std::memory_order_relaxed);
+		const int32 NarrowphasePairs = m_CollisionPairs->NarrowphasePairs.load(std::memory_order_relaxed);
+		m_BroadphasePairsSum += BroadphasePairs;
+		m_BroadphasePairsMax = FMath::Max(m_BroadphasePairsMax, BroadphasePairs);
+		m_NarrowphasePairsSum += NarrowphasePairs;
+		m_NarrowphasePairsMax = FMath::Max(m_NarrowphasePairsMax, NarrowphasePairs);
+	}
+
+	if (m_ElapsedTime >= m_WarmupDuration + m_Duration)
+	{
+		FinishRun();
+	}
+}
+
+TStatId UPhysicsSoakTestSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPhysicsSoakTestSubsystem, STATGROUP_Tickables);
+}
+
+void UPhysicsSoakTestSubsystem::FinishRun()
+{
+	m_bRunning = false;
+	const bool bPass = WriteReport();
+
+	if (m_bExitWhenDone)
+	{
+		FPlatformMisc::RequestExitWithStatus(false, bPass ? 0 : 1);
+	}
+}
+
+bool UPhysicsSoakTestSubsystem::WriteReport() const
+{
+	TArray<float> Sorted = m_FrameTimesMs;
+	Sorted.Sort();
+
+	auto Percentile = [&Sorted](float P)
+	{
+		if (Sorted.IsEmpty())
+		{
+			return 0.f;
+		}
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(P * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+		return Sorted[Index];
+	};
+
+	double Sum = 0.0;
+	for (const float FrameMs : Sorted)
+	{
+		Sum += FrameMs;
+	}
+
+	int32 ShotCount = 0;
+	int32 SwapCount = 0;
+	double SwapTimeTotalUs = 0.0;
+	double SwapTimeMaxUs = 0.0;
+	for (const APhysicsBotController* Bot : m_Bots)
+	{
+		const APhysicsCharacter* Character = Bot ? Cast<APhysicsCharacter>(Bot->GetPawn()) : nullptr;
+		if (const UWeaponInventoryComponent* Inventory = Character ? Character->GetWeaponInventory() : nullptr)
+		{
+			ShotCount += Inventory->GetShotCount();
+			SwapCount += Inventory->GetSwapCount();
+			SwapTimeTotalUs += Inventory->GetSwapTimeTotalUs();
+			SwapTimeMaxUs = FMath::Max(SwapTimeMaxUs, Inventory->GetSwapTimeMaxUs());
+		}
+	}
+
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+	constexpr double MB = 1024.0 * 1024.0;
+
+	TArray<FString> Lines;
+	// Compare server and client runs on the same seed: build, cosmetics, cpu and memory lines
+	Lines.Add(FString::Printf(TEXT("build=%s"), IsRunningDedicatedServer() ? TEXT("server") : TEXT("client")));
+	Lines.Add(FString::Printf(TEXT("cosmetics=%d"), PhysicsCosmetics::IsEnabled(this) ? 1 : 0));
+	Lines.Add(FString::Printf(TEXT("bots=%d"), m_Bots.Num()));
+	Lines.Add(FString::Printf(TEXT("seed=%d"), m_Seed));
+	Lines.Add(FString::Printf(TEXT("stress_items=%d"), m_StressItems));
+	Lines.Add(FString::Printf(TEXT("targets=%d"), ABreakableTarget::GetNumTargets()));
+	Lines.Add(FString::Printf(TEXT("active_geometry_collections=%d"), ABreakableTarget::GetNumActiveCollections()));
+	Lines.Add(FString::Printf(TEXT("active_geometry_collections_mb=%.2f"), ABreakableTarget::GetActiveCollectionBytes() / MB));
+	Lines.Add(FString::Printf(TEXT("debris_collision_filter=%d"), UDebrisCollisionFilterSubsystem::IsEnabled() ? 1 : 0));
+	if (const UDebrisCollisionFilterSubsystem* DebrisFilter = GetWorld()->GetSubsystem<UDebrisCollisionFilterSubsystem>())
+	{
+		Lines.Add(FString::Printf(TEXT("debris_static_only=%d"), DebrisFilter->GetNumStaticOnly()));
+	}
+	Lines.Add(FString::Printf(TEXT("broadphase_pairs_avg=%.1f"), Sorted.Num() ? static_cast<double>(m_BroadphasePairsSum) / Sorted.Num() : 0.0));
+	Lines.Add(FString::Printf(TEXT("broadphase_pairs_max=%d"), m_BroadphasePairsMax));
+	Lines.Add(FString::Printf(TEXT("narrowphase_pairs_avg=%.1f"), Sorted.Num() ? static_cast<double>(m_NarrowphasePairsSum) / Sorted.Num() : 0.0));
+	Lines.Add(FString::Printf(TEXT("narrowphase_pairs_max=%d"), m_NarrowphasePairsMax));
+	Lines.Add(FString::Printf(TEXT("lazy_target_collections=%d"), ABreakableTarget::IsLazyActivationEnabled() ? 1 : 0));
+	Lines.Add(FString::Printf(TEXT("duration_s=%.1f"), m_Duration));
+	Lines.Add(FString::Printf(TEXT("frames=%d"), Sorted.Num()));
+	Lines.Add(FString::Printf(TEXT("frame_ms_avg=%.3f"), Sorted.Num() ? Sum / Sorted.Num() : 0.0));
+	Lines.Add(FString::Printf(TEXT("frame_ms_p50=%.3f"), Percentile(0.50f)));
+	Lines.Add(FString::Printf(TEXT("frame_ms_p90=%.3f"), Percentile(0.90f)));
+	Lines.Add(FString::Printf(TEXT("frame_ms_p95=%.3f"), Percentile(0.95f)));
+	Lines.Add(FString::Printf(TEXT("frame_ms_p99=%.3f"), Percentile(0.99f)));
+	Lines.Add(FString::Printf(TEXT("frame_ms_max=%.3f"), Sorted.Num() ? Sorted.Last() : 0.f));
+	Lines.Add(FString::Printf(TEXT("cpu_cores=%d"), FPlatformMisc::NumberOfCoresIncludingHyperthreads()));
+	Lines.Add(FString::Printf(TEXT("cpu_pct_of_one_core_avg=%.1f"), Sorted.Num() ? m_CpuPctSum / Sorted.Num() : 0.0));
+	Lines.Add(FString::Printf(TEXT("hitch_threshold_ms=%.1f"), m_HitchThresholdMs));
+	Lines.Add(FString::Printf(TEXT("hitches=%d"), m_HitchCount));
+	if (const UPhysicsHitchDetectorSubsystem* HitchDetector = GetWorld()->GetSubsystem<UPhysicsHitchDetectorSubsystem>())
+	{
+		Lines.Add(FString::Printf(TEXT("hitch_dumps=%d"), HitchDetector->GetNumDumps()));
+	}
+	Lines.Add(FString::Printf(TEXT("used_physical_high_water_mb=%.1f"), m_UsedPhysicalHighWater / MB));
+	Lines.Add(FString::Printf(TEXT("used_virtual_high_water_mb=%.1f"), m_UsedVirtualHighWater / MB));
+	Lines.Add(FString::Printf(TEXT("peak_used_physical_mb=%.1f"), MemoryStats.PeakUsedPhysical / MB));
+	Lines.Add(FString::Printf(TEXT("shots=%d"), ShotCount));
+	Lines.Add(FString::Printf(TEXT("shots_per_bot_per_s=%.2f"), m_Bots.Num() && m_ElapsedTime > 0.f ? ShotCount / (m_Bots.Num() * m_ElapsedTime) : 0.0));
+	Lines.Add(FString::Printf(TEXT("weapon_swaps=%d"), SwapCount));
+	Lines.Add(FString::Printf(TEXT("weapon_swap_us_avg=%.2f"), SwapCount ? SwapTimeTotalUs / SwapCount : 0.0));
+	Lines.Add(FString::Printf(TEXT("weapon_swap_us_max=%.2f"), SwapTimeMaxUs));
+	if (FCombatTelemetry::IsRunning())
+	{
+		Lines.Add(FString::Printf(TEXT("telemetry_dropped=%llu"), FCombatTelemetry::GetDroppedRecords()));
+		Lines.Add(FString::Printf(TEXT("telemetry_events=%llu"), FCombatTelemetry::GetWrittenEvents()));
+		Lines.Add(FString::Printf(TEXT("telemetry_record_ns_avg=%.1f"), FCombatTelemetry::GetAverageRecordNs()));
+	}
+
+	TArray<FString> LatencyFailures;
+	if (const UPhysicsLatencySubsystem* Latency = GetWorld()->GetSubsystem<UPhysicsLatencySubsystem>())
+	{
+		Latency->AppendReport(Lines);
+		Latency->CheckBudgets(LatencyFailures);
+	}
+	Lines.Add(FString::Printf(TEXT("latency_pass=%d"), LatencyFailures.IsEmpty() ? 1 : 0));
+
+	const FString ReportPath = FPaths::ProjectSavedDir() / TEXT("Soak") / FString::Printf(TEXT("Soak_%s.txt"), *FDateTime::Now().ToString());
+	FFileHelper::SaveStringArrayToFile(Lines, *ReportPath);
+
+	UE_LOG(LogPhysicsSoak, Display, TEXT("Soak finished, report written to %s"), *ReportPath);
+	for (const FString& Line : Lines)
+	{
+		UE_LOG(LogPhysicsSoak, Display, TEXT("  %s"), *Line);
+	}
+	for (const FString& Failure : LatencyFailures)
+	{
+		UE_LOG(LogPhysicsSoak, Error, TEXT("Latency budget missed: %s"), *Failure);
+	}
+	return LatencyFailures.IsEmpty();
+}
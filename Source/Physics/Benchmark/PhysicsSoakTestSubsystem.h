@@ -0,0 +1,100 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PhysicsSoakTestSubsystem.generated.h"
+
+class APhysicsBotController;
+class FSoakCollisionPairsCallback;
+
+/**
+ * Headless soak test: spawns N bot driven characters, runs for a fixed duration,
+ * then writes frame time percentiles, hitch counts and memory high-water marks to Saved/Soak.
+ * Only created when the game is launched with -PhysicsSoak, e.g.
+ *   Physics FirstPersonMap -game -nullrhi -unattended -PhysicsSoak -SoakBots=50 -SoakDuration=120 -SoakSeed=7
+ * Add -PhysicsStress and the -Stress* switches of FStressLayoutParams to spawn a stress layout next to the bots.
+ */
+UCLASS(config=Game)
+class PHYSICS_API UPhysicsSoakTestSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Number of bots spawned, overridden by -SoakBots= */
+	UPROPERTY(config)
+	int32 m_NumBots = 50;
+
+	/** Measured duration in seconds, overridden by -SoakDuration= */
+	UPROPERTY(config)
+	float m_Duration = 120.f;
+
+	/** Seconds ignored at the start while the bots spawn and assets stream in */
+	UPROPERTY(config)
+	float m_WarmupDuration = 5.f;
+
+	/** Frames longer than this count as hitches, overridden by -SoakHitchMs= */
+	UPROPERTY(config)
+	float m_HitchThresholdMs = 50.f;
+
+	/** Seed of the first bot, each bot adds its index. Defaults to the deterministic session seed, overridden by -SoakSeed= */
+	UPROPERTY(config)
+	int32 m_Seed = 1;
+
+	/** Distance between bots in the spawn grid */
+	UPROPERTY(config)
+	float m_SpawnSpacing = 250.f;
+
+	/** Pickup actors given to every bot, bots swap between them */
+	UPROPERTY(config)
+	TArray<TSoftClassPtr<AActor>> m_BotWeaponClasses;
+
+	/** Extra distance between the bot grid and the stress layout */
+	UPROPERTY(config)
+	float m_StressLayoutOffset = 500.f;
+
+	/** Exit the process once the report is written */
+	UPROPERTY(config)
+	bool m_bExitWhenDone = true;
+
+	/** USubsystem **/
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** UWorldSubsystem **/
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** FTickableGameObject **/
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override { return m_bRunning; }
+
+protected:
+	FVector GetSpawnOrigin(UWorld& World) const;
+	void SpawnStressLayout(UWorld& World);
+	void SpawnBots(UWorld& World);
+	void FinishRun();
+	/** Writes the report, returns false when a latency budget was missed */
+	bool WriteReport() const;
+
+	UPROPERTY()
+	TArray<APhysicsBotController*> m_Bots;
+
+	TArray<float> m_FrameTimesMs;
+	double m_ElapsedTime = 0.0;
+	double m_LastFrameTime = 0.0;
+	int32 m_HitchCount = 0;
+	int32 m_StressItems = 0;
+	uint64 m_UsedPhysicalHighWater = 0;
+	uint64 m_UsedVirtualHighWater = 0;
+	/** Sum of the process CPU usage sampled every measured frame, in percent of one core */
+	double m_CpuPctSum = 0.0;
+	/** Reads the collision pair counts on the physics thread, where they are not being written concurrently */
+	FSoakCollisionPairsCallback* m_CollisionPairs = nullptr;
+	/** Chaos collision pairs of the last physics step, summed over the measured frames */
+	int64 m_BroadphasePairsSum = 0;
+	int32 m_BroadphasePairsMax = 0;
+	int64 m_NarrowphasePairsSum = 0;
+	int32 m_NarrowphasePairsMax = 0;
+	bool m_bRunning = false;
+};
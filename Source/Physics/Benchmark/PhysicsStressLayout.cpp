@@ -0,0 +1,204 @@
+#include "Benchmark/PhysicsStressLayout.h"
+#include "BreakableTarget.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "GeometryCollection/GeometryCollectionComponent.h"
+#include "GeometryCollection/GeometryCollectionObject.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPhysicsStress, Log, All);
+
+void FStressLayoutParams::ParseCommandLine(const TCHAR* CommandLine)
+{
+	FString PatternName;
+	if (FParse::Value(CommandLine, TEXT("StressPattern="), PatternName))
+	{
+		const int64 Value = StaticEnum<EStressPattern>()->GetValueByNameString(PatternName.ToUpper());
+		if (Value != INDEX_NONE)
+		{
+			m_Pattern = static_cast<EStressPattern>(Value);
+		}
+		else
+		{
+			UE_LOG(LogPhysicsStress, Warning, TEXT("Unknown stress pattern %s, keeping %s"), *PatternName, *UEnum::GetValueAsString(m_Pattern));
+		}
+	}
+	FParse::Value(CommandLine, TEXT("StressSeed="), m_Seed);
+	FParse::Value(CommandLine, TEXT("StressTargets="), m_NumTargets);
+	FParse::Value(CommandLine, TEXT("StressProps="), m_NumProps);
+	FParse::Value(CommandLine, TEXT("StressPickups="), m_NumPickups);
+	FParse::Value(CommandLine, TEXT("StressSpacing="), m_Spacing);
+	FParse::Value(CommandLine, TEXT("StressStackHeight="), m_StackHeight);
+	FParse::Value(CommandLine, TEXT("StressClusters="), m_NumClusters);
+	FParse::Value(CommandLine, TEXT("StressFracture="), m_FractureComplexity);
+}
+
+void FPhysicsStressLayout::Generate(const FStressLayoutParams& Params, TArray<FItem>& OutItems)
+{
+	const int32 Total = FMath::Max(0, Params.m_NumTargets) + FMath::Max(0, Params.m_NumProps) + FMath::Max(0, Params.m_NumPickups);
+	const float Spacing = FMath::Max(Params.m_Spacing, 10.f);
+	FRandomStream Random(Params.m_Seed);
+
+	OutItems.Reset(Total);
+	if (Total == 0)
+	{
+		return;
+	}
+
+	// Item types are shuffled over the positions, so every pattern mixes targets, props and pickups
+	TArray<EStressItem> Types;
+	Types.Init(EStressItem::TARGET, FMath::Max(0, Params.m_NumTargets));
+	Types.Reserve(Total);
+	for (int32 i = 0; i < Params.m_NumProps; ++i)
+	{
+		Types.Add(EStressItem::PROP);
+	}
+	for (int32 i = 0; i < Params.m_NumPickups; ++i)
+	{
+		Types.Add(EStressItem::PICKUP);
+	}
+	for (int32 i = Total - 1; i > 0; --i)
+	{
+		Types.Swap(i, Random.RandRange(0, i));
+	}
+
+	// Half size of a square holding every item at the requested spacing
+	const float HalfExtent = 0.5f * Spacing * FMath::Sqrt(static_cast<float>(Total));
+
+	switch (Params.m_Pattern)
+	{
+	case EStressPattern::GRID:
+	{
+		const int32 Side = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Total)));
+		for (int32 i = 0; i < Total; ++i)
+		{
+			const FVector Location((i % Side - Side / 2) * Spacing, (i / Side - Side / 2) * Spacing, 0.f);
+			OutItems.Add({ Types[i], FTransform(Location) });
+		}
+		break;
+	}
+	case EStressPattern::STACK:
+	{
+		const int32 Height = FMath::Max(1, Params.m_StackHeight);
+		const int32 Columns = FMath::DivideAndRoundUp(Total, Height);
+		const int32 Side = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Columns)));
+		for (int32 i = 0; i < Total; ++i)
+		{
+			const int32 Column = i / Height;
+			const FVector Location((Column % Side - Side / 2) * Spacing, (Column / Side - Side / 2) * Spacing, (i % Height) * Spacing);
+			OutItems.Add({ Types[i], FTransform(Location) });
+		}
+		break;
+	}
+	case EStressPattern::SCATTER:
+	{
+		for (int32 i = 0; i < Total; ++i)
+		{
+			const FVector Location(Random.FRandRange(-HalfExtent, HalfExtent), Random.FRandRange(-HalfExtent, HalfExtent), 0.f);
+			OutItems.Add({ Types[i], FTransform(FRotator(0.f, Random.FRandRange(0.f, 360.f), 0.f), Location) });
+		}
+		break;
+	}
+	case EStressPattern::CLUSTER:
+	default:
+	{
+		// Clusters are spread over twice the scatter area, and each one packs its items at the requested spacing
+		const int32 NumClusters = FMath::Clamp(Params.m_NumClusters, 1, Total);
+		const float ClusterRadius = 0.5f * Spacing * FMath::Sqrt(static_cast<float>(FMath::DivideAndRoundUp(Total, NumClusters)));
+		TArray<FVector, TInlineAllocator<32>> Centres;
+		for (int32 c = 0; c < NumClusters; ++c)
+		{
+			Centres.Add(FVector(Random.FRandRange(-2.f * HalfExtent, 2.f * HalfExtent), Random.FRandRange(-2.f * HalfExtent, 2.f * HalfExtent), 0.f));
+		}
+		for (int32 i = 0; i < Total; ++i)
+		{
+			// Square root keeps the points uniform over the disc instead of bunching at the centre
+			const float Radius = ClusterRadius * FMath::Sqrt(Random.FRand());
+			const float Angle = Random.FRandRange(0.f, UE_TWO_PI);
+			const FVector Location = Centres[i % NumClusters] + FVector(Radius * FMath::Cos(Angle), Radius * FMath::Sin(Angle), 0.f);
+			OutItems.Add({ Types[i], FTransform(FRotator(0.f, Random.FRandRange(0.f, 360.f), 0.f), Location) });
+		}
+		break;
+	}
+	}
+}
+
+int32 FPhysicsStressLayout::Spawn(UWorld& World, const FStressLayoutParams& Params, const FVector& Origin, TArray<AActor*>* OutActors)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	TArray<FItem> Items;
+	Generate(Params, Items);
+
+	const UPhysicsStressSettings* Settings = GetDefault<UPhysicsStressSettings>();
+	UClass* TargetClass = Settings->m_TargetClass.LoadSynchronous();
+	UClass* PickupClass = Settings->m_PickupClass.LoadSynchronous();
+	UStaticMesh* PropMesh = Settings->m_PropMesh.LoadSynchronous();
+	UGeometryCollection* FractureCollection = nullptr;
+	if (!Settings->m_FractureLevels.IsEmpty())
+	{
+		FractureCollection = Settings->m_FractureLevels[FMath::Clamp(Params.m_FractureComplexity, 0, Settings->m_FractureLevels.Num() - 1)].LoadSynchronous();
+	}
+
+	if ((Params.m_NumTargets > 0 && !TargetClass) || (Params.m_NumProps > 0 && !PropMesh) || (Params.m_NumPickups > 0 && !PickupClass))
+	{
+		UE_LOG(LogPhysicsStress, Warning, TEXT("Stress settings are missing assets, the corresponding items are skipped"));
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	int32 NumSpawned = 0;
+	for (const FItem& Item : Items)
+	{
+		FTransform Transform = Item.Transform;
+		Transform.AddToTranslation(Origin);
+
+		AActor* Actor = nullptr;
+		switch (Item.Type)
+		{
+		case EStressItem::TARGET:
+			if (TargetClass)
+			{
+				Actor = World.SpawnActor(TargetClass, &Transform, SpawnParams);
+				ABreakableTarget* Target = Cast<ABreakableTarget>(Actor);
+				if (Target && FractureCollection)
+				{
+					Target->GeometryCollection->SetRestCollection(FractureCollection);
+				}
+			}
+			break;
+		case EStressItem::PROP:
+			if (PropMesh)
+			{
+				AStaticMeshActor* Prop = World.SpawnActor<AStaticMeshActor>(AStaticMeshActor::StaticClass(), Transform, SpawnParams);
+				UStaticMeshComponent* Mesh = Prop->GetStaticMeshComponent();
+				Mesh->SetMobility(EComponentMobility::Movable);
+				Mesh->SetStaticMesh(PropMesh);
+				Mesh->SetWorldScale3D(FVector(Settings->m_PropScale));
+				Mesh->SetSimulatePhysics(true);
+				Actor = Prop;
+			}
+			break;
+		case EStressItem::PICKUP:
+			if (PickupClass)
+			{
+				Actor = World.SpawnActor(PickupClass, &Transform, SpawnParams);
+			}
+			break;
+		}
+
+		if (Actor)
+		{
+			++NumSpawned;
+			if (OutActors)
+			{
+				OutActors->Add(Actor);
+			}
+		}
+	}
+
+	UE_LOG(LogPhysicsStress, Display, TEXT("Spawned %d/%d stress items (%s, seed %d) in %.1fms"),
+		NumSpawned, Items.Num(), *UEnum::GetValueAsString(Params.m_Pattern), Params.m_Seed, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	return NumSpawned;
+}
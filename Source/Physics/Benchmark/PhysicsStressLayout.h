@@ -0,0 +1,112 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PhysicsStressLayout.generated.h"
+
+class UGeometryCollection;
+class UStaticMesh;
+
+UENUM(BlueprintType)
+enum class EStressPattern : uint8
+{
+	/** Square grid, one item per cell */
+	GRID,
+	/** Columns of items stacked on top of each other */
+	STACK,
+	/** Uniform random positions, same average density as the grid */
+	SCATTER,
+	/** Random cluster centres with the items packed around them */
+	CLUSTER
+};
+
+UENUM()
+enum class EStressItem : uint8
+{
+	TARGET,
+	PROP,
+	PICKUP
+};
+
+/** Parameters of a stress layout, the same parameters and seed always produce the same layout */
+USTRUCT(BlueprintType)
+struct PHYSICS_API FStressLayoutParams
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Layout)
+	EStressPattern m_Pattern = EStressPattern::GRID;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Layout)
+	int32 m_Seed = 1;
+
+	/** ABreakableTarget instances */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Layout, meta = (ClampMin = "0"))
+	int32 m_NumTargets = 200;
+
+	/** Simulated props the character can grab */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Layout, meta = (ClampMin = "0"))
+	int32 m_NumProps = 1000;
+
+	/** Weapon pickups */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Layout, meta = (ClampMin = "0"))
+	int32 m_NumPickups = 50;
+
+	/** Distance between neighbouring items, lower is denser */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Layout, meta = (ClampMin = "10"))
+	float m_Spacing = 200.f;
+
+	/** Items per column for STACK */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Layout, meta = (ClampMin = "1"))
+	int32 m_StackHeight = 5;
+
+	/** Number of clusters for CLUSTER */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Layout, meta = (ClampMin = "1"))
+	int32 m_NumClusters = 8;
+
+	/** Index into UPhysicsStressSettings::m_FractureLevels, higher is more fractured, clamped to the levels configured */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Layout, meta = (ClampMin = "0"))
+	int32 m_FractureComplexity = 0;
+
+	/** Reads -StressPattern= -StressSeed= -StressTargets= -StressProps= -StressPickups= -StressSpacing= -StressStackHeight= -StressClusters= -StressFracture= */
+	void ParseCommandLine(const TCHAR* CommandLine);
+};
+
+/** Assets the stress layouts are built from */
+UCLASS(config=Game)
+class PHYSICS_API UPhysicsStressSettings : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(config)
+	TSoftClassPtr<AActor> m_TargetClass;
+
+	UPROPERTY(config)
+	TSoftObjectPtr<UStaticMesh> m_PropMesh;
+
+	UPROPERTY(config)
+	float m_PropScale = 0.25f;
+
+	UPROPERTY(config)
+	TSoftClassPtr<AActor> m_PickupClass;
+
+	/** Geometry collections assigned to the targets, from least to most fractured. Targets keep their own when empty */
+	UPROPERTY(config)
+	TArray<TSoftObjectPtr<UGeometryCollection>> m_FractureLevels;
+};
+
+/** Builds seeded stress layouts and spawns them into a world */
+struct PHYSICS_API FPhysicsStressLayout
+{
+	struct FItem
+	{
+		EStressItem Type;
+		FTransform Transform;
+	};
+
+	/** Item transforms relative to the layout origin */
+	static void Generate(const FStressLayoutParams& Params, TArray<FItem>& OutItems);
+
+	/** Generates the layout and spawns it around Origin, returns the number of actors spawned */
+	static int32 Spawn(UWorld& World, const FStressLayoutParams& Params, const FVector& Origin, TArray<AActor*>* OutActors = nullptr);
+};
@@ -0,0 +1,84 @@
+#include "Benchmark/PhysicsStressMapCommandlet.h"
+#include "Benchmark/PhysicsStressLayout.h"
+#include "Engine/World.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPhysicsStressMap, Log, All);
+
+UPhysicsStressMapCommandlet::UPhysicsStressMapCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UPhysicsStressMapCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FStressLayoutParams Layout;
+	Layout.ParseCommandLine(*Params);
+
+	FString PackageName = FString::Printf(TEXT("/Game/Maps/Stress/Stress_%s_%d"), *StaticEnum<EStressPattern>()->GetNameStringByValue(static_cast<int64>(Layout.m_Pattern)), Layout.m_Seed);
+	FParse::Value(*Params, TEXT("Map="), PackageName);
+	if (!FPackageName::IsValidLongPackageName(PackageName))
+	{
+		UE_LOG(LogPhysicsStressMap, Error, TEXT("%s is not a valid package name"), *PackageName);
+		return 1;
+	}
+
+	UPackage* Package = CreatePackage(*PackageName);
+	UWorld::InitializationValues InitValues;
+	InitValues.ShouldSimulatePhysics(false)
+		.EnableTraceCollision(false)
+		.CreateNavigation(false)
+		.CreateAISystem(false)
+		.AllowAudioPlayback(false)
+		.RequiresHitProxies(false)
+		.CreateWorldPartition(true);
+	UWorld* World = UWorld::CreateWorld(EWorldType::Editor, false, FName(*FPackageName::GetShortName(PackageName)), Package, true, ERHIFeatureLevel::Num, &InitValues);
+	if (!World)
+	{
+		UE_LOG(LogPhysicsStressMap, Error, TEXT("Could not create the world for %s"), *PackageName);
+		return 1;
+	}
+	World->SetFlags(RF_Public | RF_Standalone);
+
+	TArray<AActor*> Actors;
+	FPhysicsStressLayout::Spawn(*World, Layout, FVector::ZeroVector, &Actors);
+
+	FSavePackageArgs SaveArgs;
+	SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+	SaveArgs.Error = GError;
+
+	const FString MapFilename = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetMapPackageExtension());
+	bool bSaved = UPackage::SavePackage(Package, World, *MapFilename, SaveArgs);
+
+	// World Partition maps keep one package per actor
+	SaveArgs.TopLevelFlags = RF_NoFlags;
+	for (AActor* Actor : Actors)
+	{
+		if (UPackage* ActorPackage = Actor->GetExternalPackage())
+		{
+			const FString ActorFilename = FPackageName::LongPackageNameToFilename(ActorPackage->GetName(), FPackageName::GetAssetPackageExtension());
+			bSaved &= UPackage::SavePackage(ActorPackage, nullptr, *ActorFilename, SaveArgs);
+		}
+	}
+
+	World->DestroyWorld(false);
+
+	if (!bSaved)
+	{
+		UE_LOG(LogPhysicsStressMap, Error, TEXT("Failed to save %s"), *PackageName);
+		return 1;
+	}
+
+	UE_LOG(LogPhysicsStressMap, Display, TEXT("Saved %d actors to %s"), Actors.Num(), *MapFilename);
+	return 0;
+#else
+	UE_LOG(LogPhysicsStressMap, Error, TEXT("Stress maps can only be saved from an editor build"));
+	return 1;
+#endif
+}
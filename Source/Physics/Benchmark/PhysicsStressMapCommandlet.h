@@ -0,0 +1,21 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PhysicsStressMapCommandlet.generated.h"
+
+/**
+ * Generates a stress layout and saves it as a World Partition map.
+ * Usage: UnrealEditor-Cmd Physics.uproject -run=PhysicsStressMap [-Map=/Game/Maps/Stress/MyMap] -StressPattern=Grid -StressTargets=2000 ...
+ * See FStressLayoutParams::ParseCommandLine for the layout switches.
+ */
+UCLASS()
+class PHYSICS_API UPhysicsStressMapCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UPhysicsStressMapCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,36 @@
+#include "Benchmark/PhysicsStressSpawner.h"
+#include "Engine/World.h"
+
+APhysicsStressSpawner::APhysicsStressSpawner()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+void APhysicsStressSpawner::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (m_bSpawnOnBeginPlay)
+	{
+		SpawnLayout();
+	}
+}
+
+int32 APhysicsStressSpawner::SpawnLayout()
+{
+	ClearLayout();
+	return FPhysicsStressLayout::Spawn(*GetWorld(), m_Layout, GetActorLocation(), &m_SpawnedActors);
+}
+
+void APhysicsStressSpawner::ClearLayout()
+{
+	for (AActor* Actor : m_SpawnedActors)
+	{
+		if (IsValid(Actor))
+		{
+			Actor->Destroy();
+		}
+	}
+	m_SpawnedActors.Reset();
+}
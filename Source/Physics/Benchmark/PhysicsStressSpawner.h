@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Benchmark/PhysicsStressLayout.h"
+#include "PhysicsStressSpawner.generated.h"
+
+/**
+ * Spawns a stress layout around itself at runtime.
+ * Placed in a level, or spawned by the soak test when launched with -PhysicsStress (layout read from the -Stress* switches).
+ */
+UCLASS()
+class PHYSICS_API APhysicsStressSpawner : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Stress)
+	FStressLayoutParams m_Layout;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Stress)
+	bool m_bSpawnOnBeginPlay = true;
+
+	APhysicsStressSpawner();
+
+	/** Destroys the previous layout and spawns m_Layout */
+	UFUNCTION(BlueprintCallable, Category = Stress)
+	int32 SpawnLayout();
+
+	UFUNCTION(BlueprintCallable, Category = Stress)
+	void ClearLayout();
+
+protected:
+	virtual void BeginPlay() override;
+
+	UPROPERTY()
+	TArray<AActor*> m_SpawnedActors;
+};
@@ -1,5 +1,29 @@
 #include "BreakableTarget.h"
 #include <GeometryCollection/GeometryCollectionComponent.h>
+#include "Simulation/DebrisBakeSubsystem.h"
+#include "Simulation/DebrisCollisionFilterSubsystem.h"
+#include "Telemetry/CombatTelemetry.h"
+#include "Profiling/PhysicsHitchDetector.h"
+#include "Profiling/PhysicsLatencyTracker.h"
+#include "UI/TargetIndicatorSubsystem.h"
+#include "PhysicsStats.h"
+#include "Engine/DamageEvents.h"
+#include "GameFramework/DamageType.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Breakable Targets"), STAT_BreakableTargets, STATGROUP_PhysicsGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Active Geometry Collections"), STAT_ActiveGeometryCollections, STATGROUP_PhysicsGame);
+DECLARE_MEMORY_STAT(TEXT("Active Geometry Collection Memory"), STAT_ActiveGeometryCollectionMemory, STATGROUP_PhysicsGame);
+
+static TAutoConsoleVariable<bool> CVarLazyTargetCollections(
+	TEXT("Physics.LazyTargetCollections"),
+	true,
+	TEXT("Keep the geometry collection of intact breakable targets unregistered until their first hit. Read when a target begins play."));
+
+bool ABreakableTarget::IsLazyActivationEnabled()
+{
+	return CVarLazyTargetCollections.GetValueOnGameThread();
+}
 
 // Sets default values
 ABreakableTarget::ABreakableTarget()
@@ -10,8 +34,13 @@ ABreakableTarget::ABreakableTarget()
 	StaticMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("StaticMesh"));
 	SetRootComponent(StaticMesh);
 
+	// Kept as a default subobject rather than created on the first hit: Bp_BreakTarget sets its rest collection in the
+	// component defaults and binds OnChaosBreakEvent as a component bound event, neither exists on a component spawned later.
+	// Unregistered it is only the UObject, the physics proxy, render state and dynamic collection come with RegisterComponent
 	GeometryCollection = CreateDefaultSubobject<UGeometryCollectionComponent>(TEXT("GeometryCollection"));
 	GeometryCollection->SetupAttachment(StaticMesh);
+	// Registered on the first hit, until then the static mesh stands in for it
+	GeometryCollection->bAutoRegister = false;
 
 	GeometryCollection->OnChaosBreakEvent.AddDynamic(this, &ABreakableTarget::GeometryCollectionBroken);
 	GeometryCollection->SetNotifyBreaks(true);
@@ -22,8 +51,184 @@ void ABreakableTarget::GeometryCollectionBroken(const FChaosBreakEvent& BreakEve
 	// @TODO: Call this function when the geometry collection breaks
 	if (!m_IsBroken)
 	{
+		PHYSICS_HITCH_SCOPE(TargetBreak, GetWorld());
 		m_IsBroken = true;
+		FCombatTelemetry::Record(ECombatEvent::BREAK, this, nullptr, BreakEvent.Mass, BreakEvent.Location);
+		FPhysicsLatencyTracker::RecordStage(m_LatencyId, ELatencyStage::BREAK);
+		if (UTargetIndicatorSubsystem* Indicators = GetWorld()->GetSubsystem<UTargetIndicatorSubsystem>())
+		{
+			Indicators->RemoveTarget(this);
+		}
 		OnBreakTarget.Broadcast(this);
 	}
 }
 
+void ABreakableTarget::BeginPlay()
+{
+	Super::BeginPlay();
+
+	++s_NumTargets;
+	INC_DWORD_STAT(STAT_BreakableTargets);
+
+	if (UTargetIndicatorSubsystem* Indicators = GetWorld()->GetSubsystem<UTargetIndicatorSubsystem>())
+	{
+		Indicators->AddTarget(this);
+	}
+
+	if (!IsLazyActivationEnabled())
+	{
+		ActivateGeometryCollection();
+	}
+}
+
+void ABreakableTarget::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	DeactivateGeometryCollection();
+
+	if (UTargetIndicatorSubsystem* Indicators = GetWorld()->GetSubsystem<UTargetIndicatorSubsystem>())
+	{
+		Indicators->RemoveTarget(this);
+	}
+
+	--s_NumTargets;
+	DEC_DWORD_STAT(STAT_BreakableTargets);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool ABreakableTarget::ActivateGeometryCollection()
+{
+	if (m_bCollectionActive)
+	{
+		return false;
+	}
+
+	PHYSICS_HITCH_SCOPE(TargetActivate, GetWorld());
+
+	if (!GeometryCollection->IsRegistered())
+	{
+		// The collision group is copied into the physics proxy when it is created
+		if (UDebrisCollisionFilterSubsystem::IsEnabled())
+		{
+			GeometryCollection->CollisionGroup = UDebrisCollisionFilterSubsystem::GetCollisionGroup(this);
+		}
+		GeometryCollection->RegisterComponent();
+	}
+	m_bCollectionActive = true;
+	++s_NumActiveCollections;
+	INC_DWORD_STAT(STAT_ActiveGeometryCollections);
+
+	// Component and its dynamic collection, both only exist in this size while the component is registered
+	const FGeometryDynamicCollection* DynamicCollection = GeometryCollection->GetDynamicCollection();
+	m_CollectionBytes = GeometryCollection->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal) + (DynamicCollection ? DynamicCollection->GetAllocatedSize() : 0);
+	s_ActiveCollectionBytes += m_CollectionBytes;
+	INC_MEMORY_STAT_BY(STAT_ActiveGeometryCollectionMemory, m_CollectionBytes);
+	return true;
+}
+
+void ABreakableTarget::DeactivateGeometryCollection()
+{
+	if (!m_bCollectionActive)
+	{
+		return;
+	}
+
+	if (GeometryCollection->IsRegistered())
+	{
+		GeometryCollection->UnregisterComponent();
+	}
+	m_bCollectionActive = false;
+	--s_NumActiveCollections;
+	DEC_DWORD_STAT(STAT_ActiveGeometryCollections);
+	s_ActiveCollectionBytes -= m_CollectionBytes;
+	DEC_MEMORY_STAT_BY(STAT_ActiveGeometryCollectionMemory, m_CollectionBytes);
+	m_CollectionBytes = 0;
+}
+
+float ABreakableTarget::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+{
+	if (const uint32 LatencyId = FPhysicsLatencyTracker::GetCurrentId())
+	{
+		m_LatencyId = LatencyId;
+	}
+
+	// Registered before Super so the blueprint damage events already see a live collection
+	const bool bFirstHit = DamageAmount > 0.f && ActivateGeometryCollection();
+
+	const float AppliedDamage = Super::TakeDamage(DamageAmount, DamageEvent, EventInstigator, DamageCauser);
+
+	if (bFirstHit)
+	{
+		ReplayDamage(DamageAmount, DamageEvent);
+	}
+	return AppliedDamage;
+}
+
+void ABreakableTarget::ReplayDamage(float DamageAmount, FDamageEvent const& DamageEvent)
+{
+	const UDamageType* DamageType = DamageEvent.DamageTypeClass ? DamageEvent.DamageTypeClass->GetDefaultObject<UDamageType>() : GetDefault<UDamageType>();
+	const float Strain = DamageAmount * m_ReplayStrainPerDamage;
+	const int32 RootIndex = GeometryCollection->GetRootIndex();
+
+	if (DamageEvent.IsOfType(FPointDamageEvent::ClassID))
+	{
+		const FPointDamageEvent& PointEvent = static_cast<const FPointDamageEvent&>(DamageEvent);
+		const FVector Location = PointEvent.HitInfo.ImpactPoint;
+		GeometryCollection->ApplyExternalStrain(RootIndex, Location, m_ReplayStrainRadius, 0, 1.f, Strain);
+		if (DamageType->DamageImpulse > 0.f)
+		{
+			GeometryCollection->AddImpulseAtLocation(PointEvent.ShotDirection.GetSafeNormal() * DamageType->DamageImpulse, Location);
+		}
+	}
+	else if (DamageEvent.IsOfType(FRadialDamageEvent::ClassID))
+	{
+		const FRadialDamageEvent& RadialEvent = static_cast<const FRadialDamageEvent&>(DamageEvent);
+		const float Radius = RadialEvent.Params.OuterRadius;
+		GeometryCollection->ApplyExternalStrain(RootIndex, RadialEvent.Origin, Radius, 0, 1.f, Strain);
+		if (DamageType->DamageImpulse > 0.f)
+		{
+			GeometryCollection->AddRadialImpulse(RadialEvent.Origin, Radius, DamageType->DamageImpulse, RIF_Linear, DamageType->bRadialDamageVelChange);
+		}
+	}
+	else
+	{
+		GeometryCollection->ApplyExternalStrain(RootIndex, GetActorLocation(), m_ReplayStrainRadius, 0, 1.f, Strain);
+	}
+}
+
+void ABreakableTarget::ResetTarget()
+{
+	m_IsBroken = false;
+
+	if (UDebrisBakeSubsystem* DebrisBake = GetWorld()->GetSubsystem<UDebrisBakeSubsystem>())
+	{
+		DebrisBake->Untrack(this);
+	}
+	if (UDebrisCollisionFilterSubsystem* DebrisFilter = GetWorld()->GetSubsystem<UDebrisCollisionFilterSubsystem>())
+	{
+		DebrisFilter->Untrack(this);
+	}
+	if (UTargetIndicatorSubsystem* Indicators = GetWorld()->GetSubsystem<UTargetIndicatorSubsystem>())
+	{
+		Indicators->AddTarget(this);
+	}
+
+	// Unregistering drops the physics proxy and the dynamic collection, the next hit starts again from the rest pose
+	DeactivateGeometryCollection();
+
+	// Damage handlers toggle visibility, collision and simulation, put both components back to their defaults
+	const UStaticMeshComponent* MeshArchetype = CastChecked<UStaticMeshComponent>(StaticMesh->GetArchetype());
+	StaticMesh->SetVisibility(MeshArchetype->IsVisible());
+	StaticMesh->SetCollisionEnabled(MeshArchetype->GetCollisionEnabled());
+	const UGeometryCollectionComponent* CollectionArchetype = CastChecked<UGeometryCollectionComponent>(GeometryCollection->GetArchetype());
+	GeometryCollection->SetVisibility(CollectionArchetype->IsVisible());
+	GeometryCollection->SetCollisionEnabled(CollectionArchetype->GetCollisionEnabled());
+	GeometryCollection->SetCollisionResponseToChannels(CollectionArchetype->GetCollisionResponseToChannels());
+	GeometryCollection->CollisionGroup = CollectionArchetype->CollisionGroup;
+	GeometryCollection->BodyInstance.bSimulatePhysics = CollectionArchetype->BodyInstance.bSimulatePhysics;
+
+	if (!IsLazyActivationEnabled())
+	{
+		ActivateGeometryCollection();
+	}
+}
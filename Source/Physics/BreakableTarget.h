@@ -23,9 +23,62 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Mesh, meta = (AllowPrivateAccess = "true"))
 	bool m_IsBroken = false;
 
+	/** Strain applied to the geometry collection per point of damage when the first hit is replayed onto it */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Damage)
+	float m_ReplayStrainPerDamage = 5000.f;
+
+	/** Radius around the hit location the replayed strain is applied in, radial damage uses its own outer radius */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Damage)
+	float m_ReplayStrainRadius = 50.f;
+
 public:	
 	UFUNCTION()
 	void GeometryCollectionBroken(const struct FChaosBreakEvent& BreakEvent);
 
+	/** Puts the target back in its unbroken state, dropping the geometry collection until the next hit */
+	UFUNCTION(BlueprintCallable)
+	void ResetTarget();
+
+	/**
+	 * Registers the geometry collection, which stays unregistered (no physics proxy, no render state) while the target is intact.
+	 * Returns false if it was already registered.
+	 */
+	bool ActivateGeometryCollection();
+
+	bool IsGeometryCollectionActive() const { return m_bCollectionActive; }
+
+	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser) override;
+
+	/** Physics.LazyTargetCollections, whether intact targets keep their geometry collection unregistered */
+	static bool IsLazyActivationEnabled();
+
+	/** Live targets and how many of them have a registered geometry collection */
+	static int32 GetNumTargets() { return s_NumTargets; }
+	static int32 GetNumActiveCollections() { return s_NumActiveCollections; }
+
+	/** Game thread memory of the registered geometry collections, measured when each one is registered */
+	static uint64 GetActiveCollectionBytes() { return s_ActiveCollectionBytes; }
+
 	static inline FBreakTarget OnBreakTarget;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** The first hit only reached the static mesh, apply its strain and impulse to the freshly registered collection */
+	void ReplayDamage(float DamageAmount, struct FDamageEvent const& DamageEvent);
+
+	void DeactivateGeometryCollection();
+
+	bool m_bCollectionActive = false;
+
+	/** Share of s_ActiveCollectionBytes added by this target's collection */
+	uint64 m_CollectionBytes = 0;
+
+	/** Latency correlation of the last input that damaged the target */
+	uint32 m_LatencyId = 0;
+
+	static inline int32 s_NumTargets = 0;
+	static inline int32 s_NumActiveCollections = 0;
+	static inline uint64 s_ActiveCollectionBytes = 0;
 };
@@ -0,0 +1,380 @@
+#pragma once
+
+// Engine independent gameplay math used by the Physics module.
+// Only depends on the C++ standard library so it can be compiled and measured outside of Unreal.
+// Batch variants take structure-of-arrays inputs and keep their loops branch free, so the compiler can vectorize them.
+
+#include <cmath>
+#include <cstdint>
+
+namespace PhysicsCore
+{
+	struct Vec3
+	{
+		float X = 0.f;
+		float Y = 0.f;
+		float Z = 0.f;
+
+		constexpr Vec3() = default;
+		constexpr Vec3(float InX, float InY, float InZ) : X(InX), Y(InY), Z(InZ) {}
+
+		constexpr Vec3 operator+(const Vec3& Other) const { return Vec3(X + Other.X, Y + Other.Y, Z + Other.Z); }
+		constexpr Vec3 operator-(const Vec3& Other) const { return Vec3(X - Other.X, Y - Other.Y, Z - Other.Z); }
+		constexpr Vec3 operator-() const { return Vec3(-X, -Y, -Z); }
+		constexpr Vec3 operator*(float Scale) const { return Vec3(X * Scale, Y * Scale, Z * Scale); }
+	};
+
+	constexpr float Dot(const Vec3& A, const Vec3& B)
+	{
+		return A.X * B.X + A.Y * B.Y + A.Z * B.Z;
+	}
+
+	/** Pitch, yaw and roll in degrees, same convention as FRotator */
+	struct Rotator
+	{
+		float Pitch = 0.f;
+		float Yaw = 0.f;
+		float Roll = 0.f;
+	};
+
+	/** Rows of the rotation matrix of a rotator, same values as FRotationMatrix */
+	struct RotationBasis
+	{
+		Vec3 Forward;
+		Vec3 Right;
+		Vec3 Up;
+	};
+
+	inline RotationBasis MakeBasis(const Rotator& Rotation)
+	{
+		constexpr float DegToRad = 3.14159265358979f / 180.f;
+		const float SP = std::sin(Rotation.Pitch * DegToRad), CP = std::cos(Rotation.Pitch * DegToRad);
+		const float SY = std::sin(Rotation.Yaw * DegToRad), CY = std::cos(Rotation.Yaw * DegToRad);
+		const float SR = std::sin(Rotation.Roll * DegToRad), CR = std::cos(Rotation.Roll * DegToRad);
+
+		RotationBasis Basis;
+		Basis.Forward = Vec3(CP * CY, CP * SY, SP);
+		Basis.Right = Vec3(SR * SP * CY - CR * SY, SR * SP * SY + CR * CY, -SR * CP);
+		Basis.Up = Vec3(-(CR * SP * CY + SR * SY), CY * SR - CR * SP * SY, CR * CP);
+		return Basis;
+	}
+
+	/** Same result as FRotator::RotateVector */
+	constexpr Vec3 RotateVector(const RotationBasis& Basis, const Vec3& Vector)
+	{
+		return Basis.Forward * Vector.X + Basis.Right * Vector.Y + Basis.Up * Vector.Z;
+	}
+
+	inline Vec3 RotateVector(const Rotator& Rotation, const Vec3& Vector)
+	{
+		return RotateVector(MakeBasis(Rotation), Vector);
+	}
+
+	// --- Stamina ---
+
+	struct StaminaParams
+	{
+		float Max = 0.f;
+		/** Stamina lost per second while sprinting */
+		float DepletionRate = 0.f;
+		/** Stamina gained per second otherwise */
+		float RecoveryRate = 0.f;
+		/** Walk speed, anything above 110% of it counts as sprinting */
+		float WalkSpeed = 0.f;
+	};
+
+	struct StaminaState
+	{
+		float Current = 0.f;
+		bool bBlockSprint = false;
+	};
+
+	/** One stamina update, sprinting is blocked once stamina runs out until the sprint input is released */
+	constexpr StaminaState StepStamina(const StaminaState& State, const StaminaParams& Params, float Speed, float DeltaSeconds)
+	{
+		StaminaState Result = State;
+		if (Speed > Params.WalkSpeed * 1.1f)
+		{
+			const float Depleted = State.Current - Params.DepletionRate * DeltaSeconds;
+			Result.Current = Depleted > 0.f ? Depleted : 0.f;
+			Result.bBlockSprint = Result.Current <= 1.e-4f;
+		}
+		else
+		{
+			const float Recovered = State.Current + Params.RecoveryRate * DeltaSeconds;
+			Result.Current = Recovered < Params.Max ? Recovered : Params.Max;
+		}
+		return Result;
+	}
+
+	/** StepStamina over arrays, BlockSprint holds 0 or 1 */
+	inline void StepStaminaBatch(float* Current, uint8_t* BlockSprint, const float* Speed, int32_t Count, const StaminaParams& Params, float DeltaSeconds)
+	{
+		const float SprintSpeed = Params.WalkSpeed * 1.1f;
+		const float Depletion = Params.DepletionRate * DeltaSeconds;
+		const float Recovery = Params.RecoveryRate * DeltaSeconds;
+		const float Max = Params.Max;
+		for (int32_t i = 0; i < Count; ++i)
+		{
+			// Plain selects and bitwise masks rather than std::fmax/fmin and a conditional store, so GCC and Clang both vectorize it
+			const bool bSprinting = Speed[i] > SprintSpeed;
+			const float Lowered = Current[i] - Depletion;
+			const float Raised = Current[i] + Recovery;
+			const float Depleted = Lowered > 0.f ? Lowered : 0.f;
+			const float Recovered = Raised < Max ? Raised : Max;
+			Current[i] = bSprinting ? Depleted : Recovered;
+			BlockSprint[i] = static_cast<uint8_t>((bSprinting & (Lowered <= 1.e-4f)) | (!bSprinting & (BlockSprint[i] != 0)));
+		}
+	}
+
+	// --- Grab ---
+
+	/** Offset from the holder of the point the grabbed object is pulled to, Distance along the view direction */
+	constexpr Vec3 GrabOffset(const Vec3& ViewDirection, float Distance)
+	{
+		return ViewDirection * Distance;
+	}
+
+	/** Velocity after one spring/damper step toward Target, Stiffness and Damping already scaled by the step time */
+	constexpr Vec3 SpringDamperVelocity(const Vec3& Position, const Vec3& Velocity, const Vec3& Target, float StiffnessDt, float DampingDt)
+	{
+		return Velocity + (Target - Position) * StiffnessDt - Velocity * DampingDt;
+	}
+
+	/** SpringDamperVelocity over one axis of many bodies, call once per axis */
+	inline void SpringDamperBatch(float* Velocity, const float* Position, const float* Target, int32_t Count, float StiffnessDt, float DampingDt)
+	{
+		for (int32_t i = 0; i < Count; ++i)
+		{
+			Velocity[i] += (Target[i] - Position[i]) * StiffnessDt - Velocity[i] * DampingDt;
+		}
+	}
+
+	// --- Damage ---
+
+	/** Direction a ray hit applies its point damage along, into the surface. Projectiles use their flight velocity as is */
+	constexpr Vec3 RayDamageDirection(const Vec3& ImpactNormal)
+	{
+		return -ImpactNormal;
+	}
+
+	// --- Weapons ---
+
+	/** Muzzle location for a muzzle offset given in aim space */
+	inline Vec3 MuzzleLocation(const Vec3& Origin, const Rotator& Aim, const Vec3& MuzzleOffset)
+	{
+		return Origin + RotateVector(Aim, MuzzleOffset);
+	}
+
+	/** MuzzleLocation for many shooters, outputs are written in place over the origins */
+	inline void MuzzleLocationBatch(float* X, float* Y, float* Z, const Rotator* Aims, int32_t Count, const Vec3& MuzzleOffset)
+	{
+		for (int32_t i = 0; i < Count; ++i)
+		{
+			const Vec3 Offset = RotateVector(Aims[i], MuzzleOffset);
+			X[i] += Offset.X;
+			Y[i] += Offset.Y;
+			Z[i] += Offset.Z;
+		}
+	}
+
+	// --- Ballistics ---
+
+	/** Closed form position of a projectile under constant gravity after Time seconds */
+	constexpr Vec3 BallisticPosition(const Vec3& Start, const Vec3& Velocity, const Vec3& Gravity, float Time)
+	{
+		return Start + Velocity * Time + Gravity * (0.5f * Time * Time);
+	}
+
+	constexpr Vec3 BallisticVelocity(const Vec3& Velocity, const Vec3& Gravity, float Time)
+	{
+		return Velocity + Gravity * Time;
+	}
+
+	/** Positions at Time = i * Interval for i in [0, Count), written to three separate arrays */
+	inline void BallisticPositionsBatch(float* OutX, float* OutY, float* OutZ, int32_t Count, const Vec3& Start, const Vec3& Velocity, const Vec3& Gravity, float Interval)
+	{
+		for (int32_t i = 0; i < Count; ++i)
+		{
+			const float T = static_cast<float>(i) * Interval;
+			const float HalfT2 = 0.5f * T * T;
+			OutX[i] = Start.X + Velocity.X * T + Gravity.X * HalfT2;
+			OutY[i] = Start.Y + Velocity.Y * T + Gravity.Y * HalfT2;
+			OutZ[i] = Start.Z + Velocity.Z * T + Gravity.Z * HalfT2;
+		}
+	}
+
+	/** Same split as UProjectileMovementComponent::ComputeBounceDelta: the normal part is scaled by Bounciness, the tangent part loses Friction */
+	constexpr Vec3 BounceVelocity(const Vec3& Velocity, const Vec3& Normal, float Bounciness, float Friction)
+	{
+		const Vec3 NormalVelocity = Normal * Dot(Velocity, Normal);
+		const Vec3 TangentVelocity = Velocity - NormalVelocity;
+		const float TangentScale = Friction < 0.f ? 1.f : (Friction > 1.f ? 0.f : 1.f - Friction);
+		return TangentVelocity * TangentScale - NormalVelocity * Bounciness;
+	}
+
+	// --- Fire scheduling ---
+
+	/** Mirrors EFireMode */
+	enum class FireMode : uint8_t
+	{
+		Auto,
+		Burst,
+		Charge
+	};
+
+	struct FireParams
+	{
+		FireMode Mode = FireMode::Auto;
+		/** Seconds between two shots */
+		double Interval = 0.1;
+		/** Shots fired by one press in Burst mode */
+		int32_t BurstCount = 3;
+		/** Extra wait after the last shot of a burst */
+		double BurstCooldown = 0.3;
+		/** Hold time a release needs to fire in Charge mode */
+		double ChargeTime = 0.5;
+	};
+
+	struct FireState
+	{
+		/** Earliest time of the next shot */
+		double NextShotTime = 0.0;
+		/** Time of the last press, for Charge mode */
+		double PressTime = 0.0;
+		int32_t BurstRemaining = 0;
+		bool bHeld = false;
+	};
+
+	/**
+	 * Advances the trigger to Now and writes the exact times of the shots due since the previous call, oldest first.
+	 * Held is the trigger state sampled this frame, a press counts as happening at Now.
+	 * At most MaxShots are written, a longer frame drops the rest and the schedule resumes from Now instead of queuing a volley.
+	 * Returns the number of shots written.
+	 */
+	inline int32_t ScheduleShots(FireState& State, const FireParams& Params, bool bHeld, double Now, double* OutShotTimes, int32_t MaxShots)
+	{
+		const bool bPressed = bHeld && !State.bHeld;
+		const bool bReleased = !bHeld && State.bHeld;
+		State.bHeld = bHeld;
+
+		// Shots never go back before the press, the cooldown of the previous shot still applies
+		if (bPressed)
+		{
+			State.PressTime = Now;
+			State.NextShotTime = State.NextShotTime > Now ? State.NextShotTime : Now;
+			if (Params.Mode == FireMode::Burst && State.BurstRemaining == 0)
+			{
+				State.BurstRemaining = Params.BurstCount;
+			}
+		}
+
+		const double Interval = Params.Interval > 1e-3 ? Params.Interval : 1e-3;
+		int32_t NumShots = 0;
+		switch (Params.Mode)
+		{
+		case FireMode::Auto:
+			while (bHeld && State.NextShotTime <= Now && NumShots < MaxShots)
+			{
+				OutShotTimes[NumShots++] = State.NextShotTime;
+				State.NextShotTime += Interval;
+			}
+			break;
+		case FireMode::Burst:
+			while (State.BurstRemaining > 0 && State.NextShotTime <= Now && NumShots < MaxShots)
+			{
+				OutShotTimes[NumShots++] = State.NextShotTime;
+				State.NextShotTime += Interval;
+				if (--State.BurstRemaining == 0)
+				{
+					State.NextShotTime += Params.BurstCooldown;
+				}
+			}
+			break;
+		case FireMode::Charge:
+			if (bReleased && Now - State.PressTime >= Params.ChargeTime && State.NextShotTime <= Now && MaxShots > 0)
+			{
+				OutShotTimes[NumShots++] = Now;
+				State.NextShotTime = Now + Interval;
+			}
+			break;
+		}
+
+		if (NumShots == MaxShots && State.NextShotTime < Now)
+		{
+			State.NextShotTime = Now;
+		}
+		return NumShots;
+	}
+
+	// --- Screen projection ---
+
+	/** Row vector matrix, same layout as FMatrix: a point is transformed as P * M */
+	struct Matrix44
+	{
+		float M[4][4];
+	};
+
+	/**
+	 * Projects world points to viewport pixels, same math as FSceneView::ProjectWorldToScreen.
+	 * OutW is the clip space W: points with W <= 0 are behind the camera and their pixels are mirrored through the centre.
+	 */
+	inline void ProjectPointsBatch(float* OutScreenX, float* OutScreenY, float* OutW, const float* X, const float* Y, const float* Z, int32_t Count, const Matrix44& ViewProjection, float Width, float Height)
+	{
+		const float (&M)[4][4] = ViewProjection.M;
+		for (int32_t i = 0; i < Count; ++i)
+		{
+			const float ClipX = X[i] * M[0][0] + Y[i] * M[1][0] + Z[i] * M[2][0] + M[3][0];
+			const float ClipY = X[i] * M[0][1] + Y[i] * M[1][1] + Z[i] * M[2][1] + M[3][1];
+			const float ClipW = X[i] * M[0][3] + Y[i] * M[1][3] + Z[i] * M[2][3] + M[3][3];
+			const float SafeW = ClipW >= 0.f ? std::fmax(ClipW, 1e-4f) : std::fmin(ClipW, -1e-4f);
+			const float InvW = 1.f / SafeW;
+			OutScreenX[i] = (0.5f + 0.5f * ClipX * InvW) * Width;
+			OutScreenY[i] = (0.5f - 0.5f * ClipY * InvW) * Height;
+			OutW[i] = ClipW;
+		}
+	}
+
+	/**
+	 * Turns projected points into indicator placements. Points in front of the camera and inside the viewport shrunk by Margin
+	 * keep their position, the others are pushed along their direction from the centre onto that inner border.
+	 * Dir is the unit direction from the centre, OnScreen is written 0 or 1.
+	 */
+	inline void ClampToScreenEdgeBatch(float* ScreenX, float* ScreenY, float* DirX, float* DirY, uint8_t* OnScreen, const float* W, int32_t Count, float Width, float Height, float Margin)
+	{
+		const float CentreX = 0.5f * Width;
+		const float CentreY = 0.5f * Height;
+		const float ExtentX = std::fmax(CentreX - Margin, 1.f);
+		const float ExtentY = std::fmax(CentreY - Margin, 1.f);
+		for (int32_t i = 0; i < Count; ++i)
+		{
+			// Undo the mirroring of points behind the camera so they point the way to turn
+			const float Side = W[i] > 0.f ? 1.f : -1.f;
+			const float DX = (ScreenX[i] - CentreX) * Side;
+			const float DY = (ScreenY[i] - CentreY) * Side;
+			const float InvLength = 1.f / std::fmax(std::sqrt(DX * DX + DY * DY), 1e-4f);
+			DirX[i] = DX * InvLength;
+			DirY[i] = DY * InvLength;
+
+			// Scale that puts the point on the border, 1 or more while it is inside
+			const float EdgeScale = std::fmin(ExtentX / std::fmax(std::fabs(DX), 1e-4f), ExtentY / std::fmax(std::fabs(DY), 1e-4f));
+			const uint8_t Inside = static_cast<uint8_t>((W[i] > 0.f) & (EdgeScale >= 1.f));
+			const float Scale = Inside ? 1.f : EdgeScale;
+			ScreenX[i] = CentreX + DX * Scale;
+			ScreenY[i] = CentreY + DY * Scale;
+			OnScreen[i] = Inside;
+		}
+	}
+
+	/** Distance from Origin to every point */
+	inline void DistanceBatch(float* OutDistance, const float* X, const float* Y, const float* Z, int32_t Count, const Vec3& Origin)
+	{
+		for (int32_t i = 0; i < Count; ++i)
+		{
+			const float DX = X[i] - Origin.X;
+			const float DY = Y[i] - Origin.Y;
+			const float DZ = Z[i] - Origin.Z;
+			OutDistance[i] = std::sqrt(DX * DX + DY * DY + DZ * DZ);
+		}
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/GameplayMath.h"
+
+// Conversions between engine types and the engine independent PhysicsCore types
+
+namespace PhysicsCore
+{
+	inline Vec3 ToCore(const FVector& Vector)
+	{
+		return Vec3(static_cast<float>(Vector.X), static_cast<float>(Vector.Y), static_cast<float>(Vector.Z));
+	}
+
+	inline Rotator ToCore(const FRotator& Rotation)
+	{
+		return Rotator{ static_cast<float>(Rotation.Pitch), static_cast<float>(Rotation.Yaw), static_cast<float>(Rotation.Roll) };
+	}
+
+	inline FVector ToEngine(const Vec3& Vector)
+	{
+		return FVector(Vector.X, Vector.Y, Vector.Z);
+	}
+}
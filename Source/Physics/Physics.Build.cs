@@ -8,7 +8,12 @@ public class Physics : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput", "Physics", "GeometryCollectionEngine" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput", "AIModule", "Physics", "GeometryCollectionEngine" });
+
+        PrivateDependencyModuleNames.AddRange(new string[] { "RenderCore", "Chaos" });
+
+        // Sounds, animations, highlights and debug messages are compiled out of the dedicated server
+        PublicDefinitions.Add("PHYSICS_WITH_COSMETICS=" + (Target.Type == TargetType.Server ? "0" : "1"));
 
         PrivateIncludePaths.Add("Physics");
     }
@@ -2,6 +2,16 @@
 
 #include "Physics.h"
 #include "Modules/ModuleManager.h"
+#include "Simulation/PhysicsDeterminism.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Physics, "Physics" );
- 
\ No newline at end of file
+class FPhysicsGameModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+		// Before any world exists, so the physics scene is created with the deterministic settings
+		FPhysicsDeterminism::ConfigureFromCommandLine();
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FPhysicsGameModule, Physics, "Physics" );
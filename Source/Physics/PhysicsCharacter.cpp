@@ -14,6 +14,14 @@
 #include <PhysicsEngine/PhysicsHandleComponent.h>
 
 #include "PhysicsGameMode.h"
+#include "TelekinesisComponent.h"
+#include "Weapons/WeaponInventoryComponent.h"
+#include "Simulation/CharacterStaminaSubsystem.h"
+#include "Simulation/DebrisBakeSubsystem.h"
+#include "Core/GameplayMathConversions.h"
+#include "Telemetry/CombatTelemetry.h"
+#include "Profiling/PhysicsLatencyTracker.h"
+#include "PhysicsCosmetics.h"
 #include "Kismet/GameplayStatics.h"
 
 DEFINE_LOG_CATEGORY(LogTemplateCharacter);
@@ -36,8 +44,12 @@ APhysicsCharacter::APhysicsCharacter()
 	Mesh1P->bCastDynamicShadow = false;
 	Mesh1P->CastShadow = false;
 	Mesh1P->SetRelativeLocation(FVector(-30.f, 0.f, -150.f));
+	// Keeps the arms mesh and its animations out of cooked server packages
+	Mesh1P->AlwaysLoadOnServer = false;
 
 	m_PhysicsHandle = CreateDefaultSubobject<UPhysicsHandleComponent>(TEXT("PhysicsHandle"));
+	m_Telekinesis = CreateDefaultSubobject<UTelekinesisComponent>(TEXT("Telekinesis"));
+	m_WeaponInventory = CreateDefaultSubobject<UWeaponInventoryComponent>(TEXT("WeaponInventory"));
 }
 
 void APhysicsCharacter::BeginPlay()
@@ -48,6 +60,26 @@ void APhysicsCharacter::BeginPlay()
 	bBlockSprint = false;
 
 	m_CurrentHealth = m_MaxHealth;
+
+	if (!PhysicsCosmetics::IsEnabled(this))
+	{
+		Mesh1P->SetComponentTickEnabled(false);
+	}
+
+	if (UCharacterStaminaSubsystem* Stamina = GetWorld()->GetSubsystem<UCharacterStaminaSubsystem>())
+	{
+		Stamina->Register(this);
+	}
+}
+
+void APhysicsCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCharacterStaminaSubsystem* Stamina = GetWorld()->GetSubsystem<UCharacterStaminaSubsystem>())
+	{
+		Stamina->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void APhysicsCharacter::Tick(float DeltaSeconds)
@@ -55,9 +87,12 @@ void APhysicsCharacter::Tick(float DeltaSeconds)
 	Super::Tick(DeltaSeconds);
 
 	// @TODO: Stamina update
-	UpdateStamina(DeltaSeconds);
+	// Stepped for all characters at once by UCharacterStaminaSubsystem
 	// @TODO: Physics objects highlight
-	FindGrabbableObjects();
+	if (PhysicsCosmetics::IsEnabled(this))
+	{
+		FindGrabbableObjects();
+	}
 	// @TODO: Grabbed object update
 	UpdateGrabbedObject();
 }
@@ -74,6 +109,8 @@ void APhysicsCharacter::NotifyControllerChanged()
 			Subsystem->AddMappingContext(DefaultMappingContext, 0);
 		}
 	}
+
+	m_WeaponInventory->BindInput();
 }
 
 void APhysicsCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -87,8 +124,14 @@ void APhysicsCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCo
 		EnhancedInputComponent->BindAction(LookAction, ETriggerEvent::Triggered, this, &APhysicsCharacter::Look);
 		EnhancedInputComponent->BindAction(SprintAction, ETriggerEvent::Triggered, this, &APhysicsCharacter::Sprint);
 		EnhancedInputComponent->BindAction(SprintAction, ETriggerEvent::Completed, this, &APhysicsCharacter::Sprint);
+		EnhancedInputComponent->BindAction(PickUpAction, ETriggerEvent::Started, this, &APhysicsCharacter::BeginGrabInput);
 		EnhancedInputComponent->BindAction(PickUpAction, ETriggerEvent::Triggered, this, &APhysicsCharacter::GrabObject);
 		EnhancedInputComponent->BindAction(PickUpAction, ETriggerEvent::Completed, this, &APhysicsCharacter::ReleaseObject);
+		if (TelekinesisAction)
+		{
+			EnhancedInputComponent->BindAction(TelekinesisAction, ETriggerEvent::Started, this, &APhysicsCharacter::TelekinesisGrab);
+			EnhancedInputComponent->BindAction(TelekinesisAction, ETriggerEvent::Completed, this, &APhysicsCharacter::TelekinesisThrow);
+		}
 	}
 	else
 	{
@@ -112,17 +155,44 @@ void APhysicsCharacter::SetIsSprinting(bool NewIsSprinting)
 void APhysicsCharacter::ChangeLife(float LifeAmount)
 {
 	m_CurrentHealth += LifeAmount;
+	if (LifeAmount < 0.f)
+	{
+		FCombatTelemetry::Record(ECombatEvent::DAMAGE, this, nullptr, -LifeAmount, GetActorLocation());
+	}
+
 	if (m_CurrentHealth > m_MaxHealth)
 	{
 		m_CurrentHealth = m_MaxHealth;
 	}
 	else if (m_CurrentHealth <= 0)
 	{
+		FCombatTelemetry::Record(ECombatEvent::DEATH, this, nullptr, m_CurrentHealth, GetActorLocation());
 		const APhysicsGameMode* GameMode = Cast<APhysicsGameMode>(UGameplayStatics::GetGameMode(this));
 		GameMode->OnLoseConditionMet.Broadcast();
 	}
 }
 
+void APhysicsCharacter::ResetState(const FVector& Location, const FRotator& Rotation, const FVector& Velocity, const FRotator& ControlRotation, float Health, float Stamina)
+{
+	if (m_GrabComponent)
+	{
+		ReleaseObject(FInputActionValue());
+	}
+	m_Telekinesis->Release();
+	SetHighlightMesh(nullptr);
+
+	SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	GetCharacterMovement()->Velocity = Velocity;
+	if (Controller)
+	{
+		Controller->SetControlRotation(ControlRotation);
+	}
+
+	m_CurrentHealth = Health;
+	m_CurrentStamina = Stamina;
+	SetIsSprinting(false);
+}
+
 void APhysicsCharacter::Move(const FInputActionValue& Value)
 {
 	// input is a Vector2D
@@ -154,16 +224,34 @@ void APhysicsCharacter::Sprint(const FInputActionValue& Value)
 	SetIsSprinting(Value.Get<bool>());
 }
 
+void APhysicsCharacter::BeginGrabInput(const FInputActionValue& Value)
+{
+	m_GrabLatencyId = FPhysicsLatencyTracker::BeginInput();
+}
+
 void APhysicsCharacter::GrabObject(const FInputActionValue& Value)
 {
 	if ( !m_GrabComponent){
-		const FHitResult Hit = RayCast();
+		FHitResult Hit = RayCast();
+
+		// Baked debris is only drawn, bring it back to life and grab the real fragment
+		UDebrisBakeSubsystem* DebrisBake = GetWorld()->GetSubsystem<UDebrisBakeSubsystem>();
+		if (DebrisBake && DebrisBake->WakeFromHit(Hit))
+		{
+			Hit = RayCast();
+		}
 		
 		if (!Hit.GetActor() || !(Hit.GetComponent()->Mobility == EComponentMobility::Movable))
 			return;
 		
 		m_GrabComponent = Hit.GetActor()->GetComponentByClass<UPrimitiveComponent>();
-		GEngine->AddOnScreenDebugMessage(-1, 3.0f, FColor::Yellow, (TEXT("Grabbing: %s"), *m_GrabComponent->GetName()));
+		FCombatTelemetry::Record(ECombatEvent::GRAB, this, Hit.GetActor(), Hit.Distance, Hit.Location);
+		FPhysicsLatencyTracker::RecordStage(m_GrabLatencyId, ELatencyStage::GRAB);
+		m_GrabLatencyId = 0;
+		if (PhysicsCosmetics::IsEnabled(this))
+		{
+			GEngine->AddOnScreenDebugMessage(-1, 3.0f, FColor::Yellow, (TEXT("Grabbing: %s"), *m_GrabComponent->GetName()));
+		}
 		m_PhysicsHandle->GrabComponentAtLocationWithRotation(m_GrabComponent, Hit.BoneName, Hit.Location, Hit.GetActor()->GetActorRotation());
 		m_fDistanceGrabbedObject = Hit.Distance;
 	}
@@ -173,10 +261,23 @@ void APhysicsCharacter::ReleaseObject(const FInputActionValue& Value)
 {
 	m_fDistanceGrabbedObject = 0.0f;
 	m_GrabComponent = nullptr;
-	GEngine->AddOnScreenDebugMessage(-1, 3.0f, FColor::Yellow, (TEXT("UN GRAB")));
+	if (PhysicsCosmetics::IsEnabled(this))
+	{
+		GEngine->AddOnScreenDebugMessage(-1, 3.0f, FColor::Yellow, (TEXT("UN GRAB")));
+	}
 	m_PhysicsHandle->ReleaseComponent();
 }
 
+void APhysicsCharacter::TelekinesisGrab(const FInputActionValue& Value)
+{
+	m_Telekinesis->Grab();
+}
+
+void APhysicsCharacter::TelekinesisThrow(const FInputActionValue& Value)
+{
+	m_Telekinesis->Throw();
+}
+
 void APhysicsCharacter::SetHighlightMesh(UMeshComponent* StaticMesh)
 {
 	if(m_HighlightedMesh)
@@ -190,22 +291,6 @@ void APhysicsCharacter::SetHighlightMesh(UMeshComponent* StaticMesh)
 	}
 }
 
-void APhysicsCharacter::UpdateStamina(float DeltaSeconds)
-{
-	if (GetCharacterMovement()->GetVelocityForNavMovement().Length() > m_fWalkSpeed * 1.1f)
-	{
-		m_CurrentStamina= m_CurrentStamina - m_StaminaDepletionRate * DeltaSeconds;
-		m_CurrentStamina = FMath::Max(0.0f, m_CurrentStamina);
-
-		bBlockSprint = m_CurrentStamina <= KINDA_SMALL_NUMBER;
-	}
-	else
-	{
-		m_CurrentStamina += m_StaminaRecoveryRate * DeltaSeconds;
-		m_CurrentStamina = FMath::Min(m_CurrentStamina, m_MaxStamina);
-	}
-}
-
 FHitResult APhysicsCharacter::RayCast() const
 {
 	FHitResult Hit;
@@ -232,6 +317,6 @@ void APhysicsCharacter::UpdateGrabbedObject()
 	if (!m_GrabComponent)return;
 
 	const FVector Forward = FirstPersonCameraComponent->GetForwardVector();
-	const FVector Location = GetActorLocation() + Forward * m_fDistanceGrabbedObject;
-	m_PhysicsHandle->SetTargetLocation(Location);
+	const PhysicsCore::Vec3 Offset = PhysicsCore::GrabOffset(PhysicsCore::ToCore(Forward), m_fDistanceGrabbedObject);
+	m_PhysicsHandle->SetTargetLocation(GetActorLocation() + PhysicsCore::ToEngine(Offset));
 }
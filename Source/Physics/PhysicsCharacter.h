@@ -14,6 +14,8 @@ class UCameraComponent;
 class UInputAction;
 class UInputMappingContext;
 class UPhysicsHandleComponent;
+class UTelekinesisComponent;
+class UWeaponInventoryComponent;
 struct FInputActionValue;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogTemplateCharacter, Log, All);
@@ -22,6 +24,11 @@ UCLASS(config=Game)
 class APhysicsCharacter : public ACharacter
 {
 	GENERATED_BODY()
+
+	/** Bots drive the character through the same entry points as player input */
+	friend class APhysicsBotController;
+	/** Stamina is stepped for every character at once, through the stamina fields below */
+	friend class UCharacterStaminaSubsystem;
 public:
 	/** Pawn mesh: 1st person view (arms; seen only by self) */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Mesh, meta = (AllowPrivateAccess = "true"))
@@ -55,6 +62,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	UInputAction* PickUpAction;
 
+	/** Telekinesis Input Action, grabs on press and throws on release */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
+	UInputAction* TelekinesisAction;
+
 	/** Sprinting speed multiplier */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Config, meta = (AllowPrivateAccess = "true"))
 	float m_SprintSpeedMultiplier;
@@ -104,16 +115,24 @@ public:
 	
 	float m_fDistanceGrabbedObject;
 	TObjectPtr<UPrimitiveComponent> m_GrabComponent;
+
+	/** Latency correlation of the pick up input, until the grab succeeds */
+	uint32 m_GrabLatencyId = 0;
 	
 protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = DebugData, meta = (AllowPrivateAccess = "true"))
 	UMeshComponent* m_HighlightedMesh = nullptr;
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = DebugData, meta = (AllowPrivateAccess = "true"))
 	UPhysicsHandleComponent* m_PhysicsHandle;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = DebugData, meta = (AllowPrivateAccess = "true"))
+	UTelekinesisComponent* m_Telekinesis;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Weapon, meta = (AllowPrivateAccess = "true"))
+	UWeaponInventoryComponent* m_WeaponInventory;
 	
 public:
 	APhysicsCharacter();
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaSeconds) override;
 
 protected:
@@ -126,13 +145,14 @@ protected:
 	void Move(const FInputActionValue& Value);
 	void Look(const FInputActionValue& Value);
 	void Sprint(const FInputActionValue& Value);
+	void BeginGrabInput(const FInputActionValue& Value);
 	void GrabObject(const FInputActionValue& Value);
 	void ReleaseObject(const FInputActionValue& Value);
+	void TelekinesisGrab(const FInputActionValue& Value);
+	void TelekinesisThrow(const FInputActionValue& Value);
 
 	void SetHighlightMesh(UMeshComponent* StaticMesh);
 
-	void UpdateStamina(float DeltaSeconds);
-
 	FHitResult RayCast() const;
 	
 	void FindGrabbableObjects();
@@ -142,6 +162,7 @@ protected:
 public:
 	USkeletalMeshComponent* GetMesh1P() const { return Mesh1P; }
 	UCameraComponent* GetFirstPersonCameraComponent() const { return FirstPersonCameraComponent; }
+	UWeaponInventoryComponent* GetWeaponInventory() const { return m_WeaponInventory; }
 	
 	void SetIsSprinting(bool NewIsSprinting);
 
@@ -153,4 +174,7 @@ public:
 	
 	UFUNCTION(BlueprintCallable)
 	float GetHealth() const {return m_CurrentHealth;};
+
+	/** Teleports the character and overwrites its attributes, used to reset a round in place */
+	void ResetState(const FVector& Location, const FRotator& Rotation, const FVector& Velocity, const FRotator& ControlRotation, float Health, float Stamina);
 };
@@ -0,0 +1,29 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/World.h"
+
+/** 0 in the PhysicsServer target, see Physics.Build.cs */
+#ifndef PHYSICS_WITH_COSMETICS
+#define PHYSICS_WITH_COSMETICS 1
+#endif
+
+namespace PhysicsCosmetics
+{
+	/**
+	 * Whether sounds, animations, highlights and debug messages are worth doing for this object.
+	 * Constant false in server builds so the cosmetic branches are compiled out, and false at runtime
+	 * when a game build is started as a dedicated server.
+	 */
+	inline bool IsEnabled(const UObject* WorldContext)
+	{
+#if PHYSICS_WITH_COSMETICS
+		const UWorld* World = WorldContext ? WorldContext->GetWorld() : nullptr;
+		return World && World->GetNetMode() != NM_DedicatedServer;
+#else
+		return false;
+#endif
+	}
+}
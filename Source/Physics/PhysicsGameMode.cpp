@@ -4,6 +4,7 @@
 #include "PhysicsCharacter.h"
 #include "UObject/ConstructorHelpers.h"
 #include "BreakableTarget.h"
+#include "Simulation/PhysicsWorldSnapshotSubsystem.h"
 #include <Kismet/GameplayStatics.h>
 
 APhysicsGameMode::APhysicsGameMode()
@@ -37,3 +38,22 @@ void APhysicsGameMode::ReduceRemainingTargets(ABreakableTarget* BrokenTarget)
 	if (m_RemainingTargets <= 0)
 		OnWinConditionMet.Broadcast();
 }
+
+bool APhysicsGameMode::RestartInPlace()
+{
+	UPhysicsWorldSnapshotSubsystem* Snapshot = GetWorld()->GetSubsystem<UPhysicsWorldSnapshotSubsystem>();
+	if (!Snapshot || !Snapshot->Restore())
+	{
+		return false;
+	}
+
+	TArray<AActor*> FoundActors;
+	UGameplayStatics::GetAllActorsOfClass(GetWorld(), ABreakableTarget::StaticClass(), FoundActors);
+	m_RemainingTargets = 0;
+	for (const AActor* Actor : FoundActors)
+	{
+		m_RemainingTargets += Cast<ABreakableTarget>(Actor)->m_IsBroken ? 0 : 1;
+	}
+	OnTargetCountChange.Broadcast();
+	return true;
+}
@@ -26,6 +26,10 @@ protected:
 	void ReduceRemainingTargets(ABreakableTarget* BrokenTarget);
 
 public:
+	/** Restarts the round by restoring the snapshot taken at BeginPlay instead of reloading the map */
+	UFUNCTION(BlueprintCallable)
+	bool RestartInPlace();
+
 	UPROPERTY(BlueprintAssignable)
 	FWinConditionMet OnWinConditionMet;
 	UPROPERTY(BlueprintAssignable)
@@ -5,6 +5,8 @@
 #include "Components/SphereComponent.h"
 #include "Weapons/WeaponDamageType.h"
 #include "Weapons/PhysicsWeaponComponent.h"
+#include "Profiling/PhysicsHitchDetector.h"
+#include "Profiling/PhysicsLatencyTracker.h"
 #include <Kismet/GameplayStatics.h>
 
 APhysicsProjectile::APhysicsProjectile() 
@@ -36,6 +38,10 @@ APhysicsProjectile::APhysicsProjectile()
 
 void APhysicsProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
+	PHYSICS_HITCH_SCOPE(ProjectileHit, GetWorld());
+	const FPhysicsLatencyTracker::FScope LatencyScope(m_LatencyId);
+	FPhysicsLatencyTracker::RecordStage(m_LatencyId, ELatencyStage::HIT);
+
 	if (OtherActor && OtherActor != this && m_OwnerWeapon)
 	{
 		m_OwnerWeapon->ApplyDamage(OtherActor, Hit, this);
@@ -37,6 +37,9 @@ public:
 	UPROPERTY(EditAnywhere)
 	float m_Radius;
 
+	/** Latency correlation of the input that fired this projectile */
+	uint32 m_LatencyId = 0;
+
 public:
 	APhysicsProjectile();
 
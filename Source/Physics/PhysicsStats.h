@@ -0,0 +1,9 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+/** Gameplay stats of the Physics module, shown with "stat PhysicsGame" */
+DECLARE_STATS_GROUP(TEXT("PhysicsGame"), STATGROUP_PhysicsGame, STATCAT_Advanced);
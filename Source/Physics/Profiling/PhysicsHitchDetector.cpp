@@ -0,0 +1,225 @@
+#include "Profiling/PhysicsHitchDetector.h"
+#include "BreakableTarget.h"
+#include "PhysicsCharacter.h"
+#include "PhysicsProjectile.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPhysicsHitch, Log, All);
+
+namespace
+{
+	/** Highest frame rate the history is sized for */
+	constexpr float MaxHistoryFrameRate = 240.f;
+}
+
+const TCHAR* FPhysicsHitchEvents::GetEventName(EPhysicsHitchEvent Event)
+{
+	switch (Event)
+	{
+	case EPhysicsHitchEvent::TargetBreak: return TEXT("TargetBreak");
+	case EPhysicsHitchEvent::TargetActivate: return TEXT("TargetActivate");
+	case EPhysicsHitchEvent::ProjectileSpawn: return TEXT("ProjectileSpawn");
+	case EPhysicsHitchEvent::ProjectileHit: return TEXT("ProjectileHit");
+	case EPhysicsHitchEvent::WeaponFire: return TEXT("WeaponFire");
+	case EPhysicsHitchEvent::WeaponAttach: return TEXT("WeaponAttach");
+	case EPhysicsHitchEvent::DebrisBake: return TEXT("DebrisBake");
+	case EPhysicsHitchEvent::DebrisWake: return TEXT("DebrisWake");
+	case EPhysicsHitchEvent::TelekinesisGrab: return TEXT("TelekinesisGrab");
+	case EPhysicsHitchEvent::SnapshotRestore: return TEXT("SnapshotRestore");
+	default: return TEXT("Unknown");
+	}
+}
+
+FPhysicsHitchScope::FPhysicsHitchScope(const UWorld* World, EPhysicsHitchEvent InEvent)
+	: Event(InEvent)
+{
+	UPhysicsHitchDetectorSubsystem* Subsystem = World ? World->GetSubsystem<UPhysicsHitchDetectorSubsystem>() : nullptr;
+	if (Subsystem && Subsystem->IsEnabled())
+	{
+		Detector = Subsystem;
+		StartCycles = FPlatformTime::Cycles64();
+	}
+}
+
+bool UPhysicsHitchDetectorSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UPhysicsHitchDetectorSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	m_bEnabled |= FParse::Param(CommandLine, TEXT("PhysicsHitches")) || FParse::Param(CommandLine, TEXT("PhysicsSoak"));
+	FParse::Value(CommandLine, TEXT("HitchBudgetMs="), m_FrameBudgetMs);
+
+	if (m_bEnabled)
+	{
+		m_History.SetNum(FMath::Max(1, FMath::CeilToInt(m_HistorySeconds * MaxHistoryFrameRate)));
+	}
+}
+
+void UPhysicsHitchDetectorSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Wall clock, the world delta time is FPhysicsDeterminism::GetFixedDeltaTime() in deterministic mode
+	const double Now = FPlatformTime::Seconds();
+	const float FrameMs = m_LastFrameTime > 0.0 ? static_cast<float>((Now - m_LastFrameTime) * 1000.0) : 0.f;
+	m_LastFrameTime = Now;
+
+	FFrameRecord& Frame = m_History[m_NextFrame];
+	Frame.FrameNumber = GFrameCounter;
+	Frame.FrameMs = FrameMs;
+	for (int32 i = 0; i < FPhysicsHitchEvents::NumEvents; ++i)
+	{
+		Frame.Counts[i] = m_Counts[i];
+		Frame.TimesMs[i] = static_cast<float>(FPlatformTime::ToMilliseconds64(m_Times[i]));
+		m_Counts[i] = 0;
+		m_Times[i] = 0;
+	}
+	m_NextFrame = (m_NextFrame + 1) % m_History.Num();
+	m_NumFrames = FMath::Min(m_NumFrames + 1, m_History.Num());
+
+	if (++m_FramesSinceStart > m_WarmupFrames && FrameMs > m_FrameBudgetMs && Now - m_LastDumpTime >= m_MinDumpInterval)
+	{
+		m_LastDumpTime = Now;
+		Dump(Frame);
+	}
+}
+
+TStatId UPhysicsHitchDetectorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPhysicsHitchDetectorSubsystem, STATGROUP_Tickables);
+}
+
+void UPhysicsHitchDetectorSubsystem::Dump(const FFrameRecord& Frame)
+{
+	constexpr int32 NumEvents = FPhysicsHitchEvents::NumEvents;
+	TArray<FString> Lines;
+	Lines.Add(FString::Printf(TEXT("frame=%llu"), Frame.FrameNumber));
+	Lines.Add(FString::Printf(TEXT("frame_ms=%.3f"), Frame.FrameMs));
+	Lines.Add(FString::Printf(TEXT("budget_ms=%.3f"), m_FrameBudgetMs));
+
+	// Hitch frame, heaviest event first
+	TArray<int32, TInlineAllocator<NumEvents>> Order;
+	float TrackedMs = 0.f;
+	for (int32 i = 0; i < NumEvents; ++i)
+	{
+		if (Frame.Counts[i] > 0)
+		{
+			Order.Add(i);
+			TrackedMs = FMath::Max(TrackedMs, Frame.TimesMs[i]);
+		}
+	}
+	Order.Sort([&Frame](int32 A, int32 B) { return Frame.TimesMs[A] > Frame.TimesMs[B]; });
+
+	Lines.Add(TEXT(""));
+	Lines.Add(TEXT("[hitch_frame]"));
+	Lines.Add(FString::Printf(TEXT("cause=%s"), Order.Num() ? FPhysicsHitchEvents::GetEventName(static_cast<EPhysicsHitchEvent>(Order[0])) : TEXT("none")));
+	for (const int32 Event : Order)
+	{
+		Lines.Add(FString::Printf(TEXT("%s count=%u time_ms=%.3f"), FPhysicsHitchEvents::GetEventName(static_cast<EPhysicsHitchEvent>(Event)), Frame.Counts[Event], Frame.TimesMs[Event]));
+	}
+	// Scopes nest, so the heaviest one bounds what the module accounts for
+	Lines.Add(FString::Printf(TEXT("untracked_ms=%.3f"), FMath::Max(0.f, Frame.FrameMs - TrackedMs)));
+
+	int32 Projectiles = 0;
+	int32 Targets = 0;
+	int32 BrokenTargets = 0;
+	int32 Characters = 0;
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		if (It->IsA<APhysicsProjectile>())
+		{
+			++Projectiles;
+		}
+		else if (const ABreakableTarget* Target = Cast<ABreakableTarget>(*It))
+		{
+			++Targets;
+			BrokenTargets += Target->m_IsBroken ? 1 : 0;
+		}
+		else if (It->IsA<APhysicsCharacter>())
+		{
+			++Characters;
+		}
+	}
+
+	Lines.Add(TEXT(""));
+	Lines.Add(TEXT("[objects]"));
+	Lines.Add(FString::Printf(TEXT("projectiles=%d"), Projectiles));
+	Lines.Add(FString::Printf(TEXT("targets=%d"), Targets));
+	Lines.Add(FString::Printf(TEXT("broken_targets=%d"), BrokenTargets));
+	Lines.Add(FString::Printf(TEXT("active_geometry_collections=%d"), ABreakableTarget::GetNumActiveCollections()));
+	Lines.Add(FString::Printf(TEXT("characters=%d"), Characters));
+
+	// Walk back from the hitch frame until the history window is covered
+	const int32 Newest = (m_NextFrame + m_History.Num() - 1) % m_History.Num();
+	int32 NumHistory = 0;
+	float HistoryMs = 0.f;
+	while (NumHistory < m_NumFrames && HistoryMs < m_HistorySeconds * 1000.f)
+	{
+		HistoryMs += m_History[(Newest - NumHistory + m_History.Num()) % m_History.Num()].FrameMs;
+		++NumHistory;
+	}
+
+	uint32 TotalCounts[NumEvents] = {};
+	float TotalMs[NumEvents] = {};
+	float PeakMs[NumEvents] = {};
+	for (int32 i = 0; i < NumHistory; ++i)
+	{
+		const FFrameRecord& Record = m_History[(Newest - i + m_History.Num()) % m_History.Num()];
+		for (int32 Event = 0; Event < NumEvents; ++Event)
+		{
+			TotalCounts[Event] += Record.Counts[Event];
+			TotalMs[Event] += Record.TimesMs[Event];
+			PeakMs[Event] = FMath::Max(PeakMs[Event], Record.TimesMs[Event]);
+		}
+	}
+
+	Lines.Add(TEXT(""));
+	Lines.Add(FString::Printf(TEXT("[history] frames=%d span_ms=%.1f"), NumHistory, HistoryMs));
+	for (int32 Event = 0; Event < NumEvents; ++Event)
+	{
+		if (TotalCounts[Event] > 0)
+		{
+			Lines.Add(FString::Printf(TEXT("%s count=%u time_ms=%.3f peak_frame_ms=%.3f"),
+				FPhysicsHitchEvents::GetEventName(static_cast<EPhysicsHitchEvent>(Event)), TotalCounts[Event], TotalMs[Event], PeakMs[Event]));
+		}
+	}
+
+	// One CSV row per frame, oldest first, so the ramp up to the hitch can be plotted
+	Lines.Add(TEXT(""));
+	Lines.Add(TEXT("[frames]"));
+	FString Header = TEXT("frame,frame_ms");
+	for (int32 Event = 0; Event < NumEvents; ++Event)
+	{
+		const TCHAR* Name = FPhysicsHitchEvents::GetEventName(static_cast<EPhysicsHitchEvent>(Event));
+		Header += FString::Printf(TEXT(",%s_count,%s_ms"), Name, Name);
+	}
+	Lines.Add(Header);
+	for (int32 i = NumHistory - 1; i >= 0; --i)
+	{
+		const FFrameRecord& Record = m_History[(Newest - i + m_History.Num()) % m_History.Num()];
+		FString Row = FString::Printf(TEXT("%llu,%.3f"), Record.FrameNumber, Record.FrameMs);
+		for (int32 Event = 0; Event < NumEvents; ++Event)
+		{
+			Row += FString::Printf(TEXT(",%u,%.3f"), Record.Counts[Event], Record.TimesMs[Event]);
+		}
+		Lines.Add(Row);
+	}
+
+	const FString DumpPath = FPaths::ProjectSavedDir() / TEXT("Hitches") / FString::Printf(TEXT("Hitch_%s_%llu.txt"), *FDateTime::Now().ToString(), Frame.FrameNumber);
+	FFileHelper::SaveStringArrayToFile(Lines, *DumpPath);
+
+	UE_LOG(LogPhysicsHitch, Warning, TEXT("%.1fms frame over the %.1fms budget (%s), history written to %s"),
+		Frame.FrameMs, m_FrameBudgetMs, Order.Num() ? FPhysicsHitchEvents::GetEventName(static_cast<EPhysicsHitchEvent>(Order[0])) : TEXT("no module event"), *DumpPath);
+
+	++m_NumDumps;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "HAL/PlatformTime.h"
+#include "PhysicsHitchDetector.generated.h"
+
+class UWorld;
+
+/** Physics module events tracked per frame by the hitch detector */
+enum class EPhysicsHitchEvent : uint8
+{
+	TargetBreak,
+	TargetActivate,
+	ProjectileSpawn,
+	ProjectileHit,
+	WeaponFire,
+	WeaponAttach,
+	DebrisBake,
+	DebrisWake,
+	TelekinesisGrab,
+	SnapshotRestore,
+	Count
+};
+
+/** Names of the tracked events, the per frame counters live in UPhysicsHitchDetectorSubsystem */
+struct PHYSICS_API FPhysicsHitchEvents
+{
+	static constexpr int32 NumEvents = static_cast<int32>(EPhysicsHitchEvent::Count);
+
+	static const TCHAR* GetEventName(EPhysicsHitchEvent Event);
+};
+
+/**
+ * Keeps the last few seconds of per frame event counters in memory, and when a frame goes over budget writes them to
+ * Saved/Hitches together with the current frame timings grouped by event and the active object counts.
+ * Enabled in config, with -PhysicsHitches or during soak tests, -HitchBudgetMs= overrides the budget.
+ */
+UCLASS(config=Game)
+class PHYSICS_API UPhysicsHitchDetectorSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(config)
+	bool m_bEnabled = false;
+
+	/** Frames longer than this are dumped, in milliseconds */
+	UPROPERTY(config)
+	float m_FrameBudgetMs = 50.f;
+
+	/** Seconds of history written before the hitch frame */
+	UPROPERTY(config)
+	float m_HistorySeconds = 5.f;
+
+	/** Minimum seconds between two dumps, a stall usually spans a few frames */
+	UPROPERTY(config)
+	float m_MinDumpInterval = 2.f;
+
+	/** Frames ignored after begin play, loading always hitches */
+	UPROPERTY(config)
+	int32 m_WarmupFrames = 60;
+
+	/** USubsystem **/
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** FTickableGameObject **/
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override { return m_bEnabled; }
+
+	bool IsEnabled() const { return m_bEnabled; }
+	int32 GetNumDumps() const { return m_NumDumps; }
+
+	/**
+	 * Counts one event of the current frame, game thread only.
+	 * Scopes nest, so times are inclusive: a ProjectileSpawn inside a WeaponFire is also part of the WeaponFire time.
+	 */
+	void AddEvent(EPhysicsHitchEvent Event, uint64 Cycles)
+	{
+		++m_Counts[static_cast<int32>(Event)];
+		m_Times[static_cast<int32>(Event)] += Cycles;
+	}
+
+protected:
+	struct FFrameRecord
+	{
+		uint64 FrameNumber = 0;
+		float FrameMs = 0.f;
+		uint32 Counts[FPhysicsHitchEvents::NumEvents] = {};
+		float TimesMs[FPhysicsHitchEvents::NumEvents] = {};
+	};
+
+	void Dump(const FFrameRecord& Frame);
+
+	/** Events of the frame being played, moved to the history on the next tick */
+	uint32 m_Counts[FPhysicsHitchEvents::NumEvents] = {};
+	uint64 m_Times[FPhysicsHitchEvents::NumEvents] = {};
+
+	/** Frame records of the last m_HistorySeconds, oldest at m_NextFrame once the ring is full */
+	TArray<FFrameRecord> m_History;
+	int32 m_NextFrame = 0;
+	int32 m_NumFrames = 0;
+
+	double m_LastFrameTime = 0.0;
+	double m_LastDumpTime = -DBL_MAX;
+	int32 m_FramesSinceStart = 0;
+	int32 m_NumDumps = 0;
+};
+
+/** Counts one event and times the enclosing scope, nothing is timed when the world has no enabled detector */
+struct PHYSICS_API FPhysicsHitchScope
+{
+	FPhysicsHitchScope(const UWorld* World, EPhysicsHitchEvent InEvent);
+
+	~FPhysicsHitchScope()
+	{
+		if (Detector)
+		{
+			Detector->AddEvent(Event, FPlatformTime::Cycles64() - StartCycles);
+		}
+	}
+
+	UPhysicsHitchDetectorSubsystem* Detector = nullptr;
+	EPhysicsHitchEvent Event;
+	uint64 StartCycles = 0;
+};
+
+#define PHYSICS_HITCH_SCOPE(Event, World) FPhysicsHitchScope ANONYMOUS_VARIABLE(PhysicsHitchScope)(World, EPhysicsHitchEvent::Event)
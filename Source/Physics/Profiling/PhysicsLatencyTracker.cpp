@@ -0,0 +1,208 @@
+#include "Profiling/PhysicsLatencyTracker.h"
+#include "Engine/Engine.h"
+#include "HAL/IConsoleManager.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "RenderingThread.h"
+
+CSV_DEFINE_CATEGORY(PhysicsLatency, true);
+
+static TAutoConsoleVariable<bool> CVarShowLatency(
+	TEXT("Physics.ShowLatency"),
+	false,
+	TEXT("Show the input to outcome latency histograms on screen."));
+
+const float FLatencyHistogram::BucketEdgesMs[NumEdges] = { 1.f, 2.f, 4.f, 8.f, 12.f, 17.f, 25.f, 33.f, 50.f, 66.f, 100.f, 150.f, 250.f, 500.f };
+
+void FLatencyHistogram::Add(float LatencyMs)
+{
+	int32 Bucket = 0;
+	while (Bucket < NumEdges && LatencyMs > BucketEdgesMs[Bucket])
+	{
+		++Bucket;
+	}
+	++Buckets[Bucket];
+	++Count;
+	SumMs += LatencyMs;
+	MaxMs = FMath::Max(MaxMs, LatencyMs);
+}
+
+float FLatencyHistogram::GetPercentile(float Percentile) const
+{
+	if (Count == 0)
+	{
+		return 0.f;
+	}
+
+	const uint32 Rank = FMath::Max<uint32>(1, FMath::CeilToInt(Percentile * Count));
+	uint32 Seen = 0;
+	for (int32 Bucket = 0; Bucket < NumEdges; ++Bucket)
+	{
+		Seen += Buckets[Bucket];
+		if (Seen >= Rank)
+		{
+			return FMath::Min(BucketEdgesMs[Bucket], MaxMs);
+		}
+	}
+	return MaxMs;
+}
+
+uint32 FPhysicsLatencyTracker::BeginInput()
+{
+	const uint32 Id = s_NextId++;
+	if (s_NextId == 0)
+	{
+		s_NextId = 1;
+	}
+
+	FInFlight& InFlight = s_InFlight.Add(Id);
+	InFlight.InputCycles = FPlatformTime::Cycles64();
+	return Id;
+}
+
+void FPhysicsLatencyTracker::RecordStageAt(uint32 Id, ELatencyStage Stage, uint64 Cycles)
+{
+	FInFlight* InFlight = Id ? s_InFlight.Find(Id) : nullptr;
+	const uint8 StageBit = 1 << static_cast<uint8>(Stage);
+	if (!InFlight || (InFlight->RecordedStages & StageBit))
+	{
+		return;
+	}
+	InFlight->RecordedStages |= StageBit;
+
+	const float LatencyMs = static_cast<float>(FPlatformTime::ToMilliseconds64(Cycles - InFlight->InputCycles));
+	s_Histograms[static_cast<int32>(Stage)].Add(LatencyMs);
+
+#if CSV_PROFILER
+	static const char* const CsvStatNames[] = { "Fire", "Hit", "Damage", "Break", "Grab", "Present" };
+	static_assert(UE_ARRAY_COUNT(CsvStatNames) == static_cast<int32>(ELatencyStage::COUNT), "One CSV stat per latency stage");
+	FCsvProfiler::RecordCustomStat(CsvStatNames[static_cast<int32>(Stage)], CSV_CATEGORY_INDEX(PhysicsLatency), LatencyMs, ECsvCustomStatOp::Max);
+#endif
+
+	// The first visible outcome of the input waits for the render thread to pick up its frame
+	const bool bOutcome = Stage == ELatencyStage::HIT || Stage == ELatencyStage::DAMAGE || Stage == ELatencyStage::BREAK || Stage == ELatencyStage::GRAB;
+	if (bOutcome && !InFlight->bPresentQueued)
+	{
+		InFlight->bPresentQueued = true;
+		s_PendingPresent.Add(Id);
+	}
+}
+
+void FPhysicsLatencyTracker::ResetHistograms()
+{
+	for (FLatencyHistogram& Histogram : s_Histograms)
+	{
+		Histogram = FLatencyHistogram();
+	}
+}
+
+bool UPhysicsLatencySubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UPhysicsLatencySubsystem::Deinitialize()
+{
+	// Correlations carried by actors of this world can not complete anymore
+	FPhysicsLatencyTracker::s_InFlight.Reset();
+	FPhysicsLatencyTracker::s_PendingPresent.Reset();
+
+	Super::Deinitialize();
+}
+
+void UPhysicsLatencySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TPair<uint32, uint64> Presented;
+	while (m_Presented->Dequeue(Presented))
+	{
+		FPhysicsLatencyTracker::RecordStageAt(Presented.Key, ELatencyStage::PRESENT, Presented.Value);
+	}
+
+	if (!FPhysicsLatencyTracker::s_PendingPresent.IsEmpty())
+	{
+		// Runs once the render thread processes the commands of this frame
+		ENQUEUE_RENDER_COMMAND(PhysicsLatencyPresent)(
+			[Ids = MoveTemp(FPhysicsLatencyTracker::s_PendingPresent), Presented = m_Presented](FRHICommandListImmediate&)
+			{
+				const uint64 Cycles = FPlatformTime::Cycles64();
+				for (const uint32 Id : Ids)
+				{
+					Presented->Enqueue(TPair<uint32, uint64>(Id, Cycles));
+				}
+			});
+		FPhysicsLatencyTracker::s_PendingPresent.Reset();
+	}
+
+	const uint64 Now = FPlatformTime::Cycles64();
+	const uint64 MaxAgeCycles = static_cast<uint64>(m_MaxCorrelationAge / FPlatformTime::GetSecondsPerCycle64());
+	for (auto It = FPhysicsLatencyTracker::s_InFlight.CreateIterator(); It; ++It)
+	{
+		if (Now - It.Value().InputCycles > MaxAgeCycles)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	if (CVarShowLatency.GetValueOnGameThread())
+	{
+		ShowOnScreen();
+	}
+}
+
+TStatId UPhysicsLatencySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPhysicsLatencySubsystem, STATGROUP_Tickables);
+}
+
+void UPhysicsLatencySubsystem::ShowOnScreen() const
+{
+	if (!GEngine)
+	{
+		return;
+	}
+
+	const UEnum* StageEnum = StaticEnum<ELatencyStage>();
+	for (int32 Stage = 0; Stage < static_cast<int32>(ELatencyStage::COUNT); ++Stage)
+	{
+		const FLatencyHistogram& Histogram = FPhysicsLatencyTracker::GetHistogram(static_cast<ELatencyStage>(Stage));
+		// Fixed keys so every stage keeps its line instead of scrolling
+		const uint64 Key = GetTypeHash(TEXT("PhysicsLatency")) + Stage;
+		GEngine->AddOnScreenDebugMessage(Key, 0.f, FColor::Cyan, FString::Printf(TEXT("%-8s n=%-6u avg %6.1fms  p50 %6.1fms  p95 %6.1fms  max %6.1fms"),
+			*StageEnum->GetNameStringByValue(Stage), Histogram.Count, Histogram.GetAverage(), Histogram.GetPercentile(0.5f), Histogram.GetPercentile(0.95f), Histogram.MaxMs));
+	}
+}
+
+void UPhysicsLatencySubsystem::AppendReport(TArray<FString>& OutLines) const
+{
+	const UEnum* StageEnum = StaticEnum<ELatencyStage>();
+	for (int32 Stage = 0; Stage < static_cast<int32>(ELatencyStage::COUNT); ++Stage)
+	{
+		const FLatencyHistogram& Histogram = FPhysicsLatencyTracker::GetHistogram(static_cast<ELatencyStage>(Stage));
+		if (Histogram.Count == 0)
+		{
+			continue;
+		}
+		const FString Name = StageEnum->GetNameStringByValue(Stage).ToLower();
+		OutLines.Add(FString::Printf(TEXT("latency_%s_count=%u"), *Name, Histogram.Count));
+		OutLines.Add(FString::Printf(TEXT("latency_%s_ms_avg=%.2f"), *Name, Histogram.GetAverage()));
+		OutLines.Add(FString::Printf(TEXT("latency_%s_ms_p50=%.2f"), *Name, Histogram.GetPercentile(0.5f)));
+		OutLines.Add(FString::Printf(TEXT("latency_%s_ms_p95=%.2f"), *Name, Histogram.GetPercentile(0.95f)));
+		OutLines.Add(FString::Printf(TEXT("latency_%s_ms_max=%.2f"), *Name, Histogram.MaxMs));
+	}
+}
+
+bool UPhysicsLatencySubsystem::CheckBudgets(TArray<FString>& OutFailures) const
+{
+	for (const TPair<ELatencyStage, float>& Budget : m_P95BudgetsMs)
+	{
+		const FLatencyHistogram& Histogram = FPhysicsLatencyTracker::GetHistogram(Budget.Key);
+		const float P95 = Histogram.GetPercentile(0.95f);
+		if (Histogram.Count > 0 && P95 > Budget.Value)
+		{
+			OutFailures.Add(FString::Printf(TEXT("%s p95 %.1fms > %.1fms"), *UEnum::GetValueAsString(Budget.Key), P95, Budget.Value));
+		}
+	}
+	return OutFailures.IsEmpty();
+}
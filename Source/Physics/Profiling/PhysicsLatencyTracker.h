@@ -0,0 +1,126 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Containers/Queue.h"
+#include "PhysicsLatencyTracker.generated.h"
+
+/** Points on the path from an input to its visible outcome, latencies are measured from the input */
+UENUM(BlueprintType)
+enum class ELatencyStage : uint8
+{
+	/** UPhysicsWeaponComponent::Fire reached */
+	FIRE,
+	/** Hitscan trace result or projectile hit */
+	HIT,
+	/** ApplyDamage */
+	DAMAGE,
+	/** Geometry collection break event of a target damaged by the input */
+	BREAK,
+	/** APhysicsCharacter::GrabObject picked a component */
+	GRAB,
+	/** Render thread reached the frame of the first outcome (hit, damage, break or grab) */
+	PRESENT,
+	COUNT UMETA(Hidden)
+};
+
+/** Latency histogram with fixed buckets, percentiles are reported as the upper edge of their bucket */
+struct PHYSICS_API FLatencyHistogram
+{
+	static constexpr int32 NumEdges = 14;
+	static const float BucketEdgesMs[NumEdges];
+
+	uint32 Buckets[NumEdges + 1] = {};
+	uint32 Count = 0;
+	double SumMs = 0.0;
+	float MaxMs = 0.f;
+
+	void Add(float LatencyMs);
+	float GetPercentile(float Percentile) const;
+	float GetAverage() const { return Count ? static_cast<float>(SumMs / Count) : 0.f; }
+};
+
+/**
+ * Input to outcome latency tracking, game thread only.
+ * Each input gets a correlation id that is current while its handler runs; projectiles and targets carry it
+ * to the stages that happen later (projectile hits, break events).
+ */
+class PHYSICS_API FPhysicsLatencyTracker
+{
+public:
+	/** Starts a correlation for an input dispatched now, make it current with FScope while the input is handled */
+	static uint32 BeginInput();
+
+	/** Id of the input being handled, 0 outside of input handlers */
+	static uint32 GetCurrentId() { return s_CurrentId; }
+
+	/** Records the first time a correlation reaches a stage, ignored for id 0 and expired ids */
+	static void RecordStage(uint32 Id, ELatencyStage Stage) { RecordStageAt(Id, Stage, FPlatformTime::Cycles64()); }
+	static void RecordStageAt(uint32 Id, ELatencyStage Stage, uint64 Cycles);
+
+	static const FLatencyHistogram& GetHistogram(ELatencyStage Stage) { return s_Histograms[static_cast<int32>(Stage)]; }
+	static void ResetHistograms();
+
+	/** Makes an id current for the scope, used when a later stage runs outside of the input handler */
+	struct FScope
+	{
+		explicit FScope(uint32 Id) : PreviousId(s_CurrentId) { s_CurrentId = Id; }
+		~FScope() { s_CurrentId = PreviousId; }
+		uint32 PreviousId;
+	};
+
+private:
+	friend class UPhysicsLatencySubsystem;
+
+	struct FInFlight
+	{
+		uint64 InputCycles = 0;
+		uint8 RecordedStages = 0;
+		bool bPresentQueued = false;
+	};
+
+	static inline uint32 s_CurrentId = 0;
+	static inline uint32 s_NextId = 1;
+	static inline TMap<uint32, FInFlight> s_InFlight;
+	static inline TArray<uint32> s_PendingPresent;
+	static inline FLatencyHistogram s_Histograms[static_cast<int32>(ELatencyStage::COUNT)];
+};
+
+/**
+ * Drives the present stage, expires old correlations and publishes the histograms:
+ * on screen with Physics.ShowLatency 1, and per frame worst latencies in the CSV profiler (PhysicsLatency category).
+ */
+UCLASS(config=Game)
+class PHYSICS_API UPhysicsLatencySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Correlations older than this are dropped, in seconds */
+	UPROPERTY(config)
+	float m_MaxCorrelationAge = 10.f;
+
+	/** P95 budget per stage in milliseconds, checked by automated benchmarks */
+	UPROPERTY(config)
+	TMap<ELatencyStage, float> m_P95BudgetsMs;
+
+	/** USubsystem **/
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	/** FTickableGameObject **/
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Appends key=value lines with the histograms of every stage that has samples */
+	void AppendReport(TArray<FString>& OutLines) const;
+
+	/** Returns false and lists the stages whose P95 is over budget */
+	bool CheckBudgets(TArray<FString>& OutFailures) const;
+
+protected:
+	void ShowOnScreen() const;
+
+	/** Present timestamps written by the render thread */
+	TSharedRef<TQueue<TPair<uint32, uint64>, EQueueMode::Mpsc>, ESPMode::ThreadSafe> m_Presented = MakeShared<TQueue<TPair<uint32, uint64>, EQueueMode::Mpsc>, ESPMode::ThreadSafe>();
+};
@@ -0,0 +1,83 @@
+#include "Simulation/CharacterStaminaSubsystem.h"
+#include "PhysicsCharacter.h"
+#include "PhysicsStats.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Character Stamina"), STAT_CharacterStamina, STATGROUP_PhysicsGame);
+
+bool UCharacterStaminaSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+TStatId UCharacterStaminaSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCharacterStaminaSubsystem, STATGROUP_Tickables);
+}
+
+void UCharacterStaminaSubsystem::Register(APhysicsCharacter* Character)
+{
+	m_Characters.AddUnique(Character);
+}
+
+void UCharacterStaminaSubsystem::Unregister(APhysicsCharacter* Character)
+{
+	m_Characters.RemoveSwap(Character);
+}
+
+void UCharacterStaminaSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_CharacterStamina);
+
+	for (FStaminaBatch& Batch : m_Batches)
+	{
+		Batch.Characters.Reset();
+		Batch.Current.Reset();
+		Batch.Speed.Reset();
+		Batch.BlockSprint.Reset();
+	}
+
+	// Characters of the same class share their settings, so there are only a handful of batches
+	for (const TWeakObjectPtr<APhysicsCharacter>& CharacterPtr : m_Characters)
+	{
+		APhysicsCharacter* Character = CharacterPtr.Get();
+		if (!Character)
+		{
+			continue;
+		}
+
+		const PhysicsCore::StaminaParams Params{ Character->m_MaxStamina, Character->m_StaminaDepletionRate, Character->m_StaminaRecoveryRate, Character->m_fWalkSpeed };
+		FStaminaBatch* Batch = m_Batches.FindByPredicate([&Params](const FStaminaBatch& Candidate)
+		{
+			return Candidate.Params.Max == Params.Max && Candidate.Params.DepletionRate == Params.DepletionRate
+				&& Candidate.Params.RecoveryRate == Params.RecoveryRate && Candidate.Params.WalkSpeed == Params.WalkSpeed;
+		});
+		if (!Batch)
+		{
+			Batch = &m_Batches.AddDefaulted_GetRef();
+			Batch->Params = Params;
+		}
+
+		Batch->Characters.Add(Character);
+		Batch->Current.Add(Character->m_CurrentStamina);
+		Batch->Speed.Add(static_cast<float>(Character->GetCharacterMovement()->GetVelocityForNavMovement().Length()));
+		Batch->BlockSprint.Add(Character->bBlockSprint ? 1 : 0);
+	}
+
+	for (FStaminaBatch& Batch : m_Batches)
+	{
+		PhysicsCore::StepStaminaBatch(Batch.Current.GetData(), Batch.BlockSprint.GetData(), Batch.Speed.GetData(), Batch.Characters.Num(), Batch.Params, DeltaTime);
+		for (int32 i = 0; i < Batch.Characters.Num(); ++i)
+		{
+			Batch.Characters[i]->m_CurrentStamina = Batch.Current[i];
+			Batch.Characters[i]->bBlockSprint = Batch.BlockSprint[i] != 0;
+		}
+	}
+
+	// Settings that no character uses any more
+	m_Batches.RemoveAllSwap([](const FStaminaBatch& Batch) { return Batch.Characters.IsEmpty(); });
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Core/GameplayMath.h"
+#include "CharacterStaminaSubsystem.generated.h"
+
+class APhysicsCharacter;
+
+/**
+ * Steps the stamina of every APhysicsCharacter of the world once per frame.
+ * Characters sharing the same stamina settings are gathered into arrays and go through one PhysicsCore::StepStaminaBatch call,
+ * instead of one StepStamina call per character tick.
+ */
+UCLASS()
+class PHYSICS_API UCharacterStaminaSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** USubsystem **/
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/** FTickableGameObject **/
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override { return !m_Characters.IsEmpty(); }
+
+	void Register(APhysicsCharacter* Character);
+	void Unregister(APhysicsCharacter* Character);
+
+protected:
+	/** Characters sharing one set of stamina settings, rebuilt every frame */
+	struct FStaminaBatch
+	{
+		PhysicsCore::StaminaParams Params;
+		TArray<APhysicsCharacter*> Characters;
+		TArray<float> Current;
+		TArray<float> Speed;
+		TArray<uint8> BlockSprint;
+	};
+
+	TArray<TWeakObjectPtr<APhysicsCharacter>> m_Characters;
+
+	/** Kept between frames so the arrays keep their allocation */
+	TArray<FStaminaBatch> m_Batches;
+};
@@ -0,0 +1,415 @@
+#include "Simulation/DebrisBakeSubsystem.h"
+#include "BreakableTarget.h"
+#include "PhysicsStats.h"
+#include "Profiling/PhysicsHitchDetector.h"
+#include "Chaos/SimCallbackObject.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/OverlapResult.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "GeometryCollection/GeometryCollection.h"
+#include "GeometryCollection/GeometryCollectionComponent.h"
+#include "GeometryCollection/GeometryCollectionObject.h"
+#include "GeometryCollection/Facades/CollectionInstancedMeshFacade.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PBDRigidsSolver.h"
+#include <atomic>
+
+DEFINE_LOG_CATEGORY_STATIC(LogDebrisBake, Log, All);
+
+DECLARE_CYCLE_STAT(TEXT("Debris Bake"), STAT_DebrisBake, STATGROUP_PhysicsGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Solver Active Particles"), STAT_SolverActiveParticles, STATGROUP_PhysicsGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Solver Dynamic Particles"), STAT_SolverDynamicParticles, STATGROUP_PhysicsGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Debris Baked Instances"), STAT_DebrisBakedInstances, STATGROUP_PhysicsGame);
+
+/** Reads the solver particle counts at the start of every step, on the physics thread */
+class FDebrisParticleCountCallback : public Chaos::TSimCallbackObject<>
+{
+public:
+	std::atomic<int32> NumActive{ 0 };
+	std::atomic<int32> NumDynamic{ 0 };
+
+private:
+	virtual void OnPreSimulate_Internal() override
+	{
+		const Chaos::FPBDRigidsSOAs& Particles = static_cast<Chaos::FPBDRigidsSolver*>(GetSolver())->GetParticles();
+		NumActive.store(Particles.GetActiveParticlesView().Num(), std::memory_order_relaxed);
+		NumDynamic.store(Particles.GetNonDisabledDynamicView().Num(), std::memory_order_relaxed);
+	}
+};
+
+namespace
+{
+	bool IsLeaf(const FGeometryCollection& Collection, int32 TransformIndex)
+	{
+		return Collection.Children[TransformIndex].Num() == 0;
+	}
+}
+
+bool UDebrisBakeSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UDebrisBakeSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	ABreakableTarget::OnBreakTarget.AddDynamic(this, &UDebrisBakeSubsystem::OnTargetBroken);
+}
+
+void UDebrisBakeSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	FPhysScene* Scene = InWorld.GetPhysicsScene();
+	if (Chaos::FPBDRigidsSolver* Solver = Scene ? Scene->GetSolver() : nullptr)
+	{
+		m_ParticleCounts = Solver->CreateAndRegisterSimCallbackObject_External<FDebrisParticleCountCallback>();
+	}
+}
+
+void UDebrisBakeSubsystem::Deinitialize()
+{
+	ABreakableTarget::OnBreakTarget.RemoveDynamic(this, &UDebrisBakeSubsystem::OnTargetBroken);
+
+	if (m_ParticleCounts)
+	{
+		if (Chaos::FPBDRigidsSolver* Solver = static_cast<Chaos::FPBDRigidsSolver*>(m_ParticleCounts->GetSolver()))
+		{
+			Solver->UnregisterAndFreeSimCallbackObject_External(m_ParticleCounts);
+		}
+		m_ParticleCounts = nullptr;
+	}
+
+	Super::Deinitialize();
+}
+
+TStatId UDebrisBakeSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDebrisBakeSubsystem, STATGROUP_Tickables);
+}
+
+void UDebrisBakeSubsystem::OnTargetBroken(ABreakableTarget* Target)
+{
+	if (!Target || Target->GetWorld() != GetWorld() || !Target->GeometryCollection)
+	{
+		return;
+	}
+
+	FTrackedDebris& Debris = m_FreeSlots.IsEmpty() ? m_Tracked.AddDefaulted_GetRef() : m_Tracked[m_FreeSlots.Pop(EAllowShrinking::No)];
+	Debris.Target = Target;
+	Debris.Component = Target->GeometryCollection;
+}
+
+void UDebrisBakeSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UpdateStats();
+
+	m_TimeToCheck -= DeltaTime;
+	if (m_TimeToCheck > 0.f)
+	{
+		return;
+	}
+	m_TimeToCheck = m_CheckInterval;
+
+	SCOPE_CYCLE_COUNTER(STAT_DebrisBake);
+
+	const int32 BakedBefore = m_NumBakedInstances;
+	for (int32 i = 0; i < m_Tracked.Num(); ++i)
+	{
+		FTrackedDebris& Debris = m_Tracked[i];
+		if (Debris.Target.IsExplicitlyNull())
+		{
+			continue;
+		}
+
+		// Nothing left to bake or wake once the target is gone, or when its collection cannot be baked
+		if (!Debris.Target.IsValid() || (!Debris.bBaked && !Debris.Component.IsValid()))
+		{
+			Wake(i);
+			FreeSlot(i);
+			continue;
+		}
+
+		if (!Debris.bBaked && UpdateSettled(Debris))
+		{
+			Bake(i);
+		}
+	}
+
+	if (BakedBefore != m_NumBakedInstances)
+	{
+		UE_LOG(LogDebrisBake, Verbose, TEXT("Debris baked, baked instances %d -> %d, solver dynamic particles %d"), BakedBefore, m_NumBakedInstances, GetNumDynamicParticles());
+	}
+}
+
+bool UDebrisBakeSubsystem::UpdateSettled(FTrackedDebris& Debris)
+{
+	const auto& Transforms = Debris.Component->GetComponentSpaceTransforms();
+
+	bool bStill = Debris.LastPositions.Num() == Transforms.Num();
+	Debris.LastPositions.SetNum(Transforms.Num());
+	for (int32 i = 0; i < Transforms.Num(); ++i)
+	{
+		const FVector Position(Transforms[i].GetTranslation());
+		bStill &= FVector::DistSquared(Position, Debris.LastPositions[i]) <= FMath::Square(m_SleepTolerance);
+		Debris.LastPositions[i] = Position;
+	}
+
+	Debris.StillTime = bStill ? Debris.StillTime + m_CheckInterval : 0.f;
+	return Debris.StillTime >= m_SleepTimeout;
+}
+
+UDebrisBakeSubsystem::FDebrisMeshBatch& UDebrisBakeSubsystem::FindOrAddBatch(UStaticMesh* Mesh)
+{
+	FDebrisMeshBatch& Batch = m_Batches.FindOrAdd(Mesh);
+	if (Batch.Instances.IsValid())
+	{
+		return Batch;
+	}
+
+	if (!m_BakeActor)
+	{
+		m_BakeActor = GetWorld()->SpawnActor<AActor>();
+		USceneComponent* Root = NewObject<USceneComponent>(m_BakeActor, TEXT("Root"));
+		m_BakeActor->SetRootComponent(Root);
+		Root->RegisterComponent();
+	}
+
+	// Instances are placed in world space, the bake actor stays at the origin
+	UInstancedStaticMeshComponent* Instances = NewObject<UInstancedStaticMeshComponent>(m_BakeActor);
+	Instances->SetStaticMesh(Mesh);
+	Instances->SetMobility(EComponentMobility::Movable);
+	Instances->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	Instances->SetCollisionObjectType(ECC_WorldDynamic);
+	Instances->SetCollisionResponseToAllChannels(ECR_Block);
+	Instances->SetupAttachment(m_BakeActor->GetRootComponent());
+	Instances->RegisterComponent();
+
+	Batch.Instances = Instances;
+	Batch.Owners.Reset();
+	return Batch;
+}
+
+bool UDebrisBakeSubsystem::Bake(int32 TrackedIndex)
+{
+	PHYSICS_HITCH_SCOPE(DebrisBake, GetWorld());
+
+	FTrackedDebris& Debris = m_Tracked[TrackedIndex];
+	UGeometryCollectionComponent* Component = Debris.Component.Get();
+	const UGeometryCollection* RestCollection = Component->GetRestCollection();
+	const TSharedPtr<FGeometryCollection, ESPMode::ThreadSafe> Collection = RestCollection ? RestCollection->GetGeometryCollection() : nullptr;
+	if (!Collection)
+	{
+		return false;
+	}
+
+	const GeometryCollection::Facades::FCollectionInstancedMeshFacade MeshFacade(*Collection);
+	if (!MeshFacade.IsValid())
+	{
+		// Nothing to draw the fragments with, keep them simulated and stop checking
+		UE_LOG(LogDebrisBake, Log, TEXT("%s has no auto instance meshes, its debris cannot be baked"), *GetNameSafe(RestCollection));
+		Debris.Component = nullptr;
+		return false;
+	}
+
+	const FTransform ComponentTransform = Component->GetComponentTransform();
+	const auto& Transforms = Component->GetComponentSpaceTransforms();
+
+	TMap<UStaticMesh*, TArray<FTransform>> InstancesByMesh;
+	for (int32 i = 0; i < Transforms.Num(); ++i)
+	{
+		const int32 MeshIndex = MeshFacade.GetIndex(i);
+		if (!IsLeaf(*Collection, i) || !RestCollection->AutoInstanceMeshes.IsValidIndex(MeshIndex))
+		{
+			continue;
+		}
+		if (UStaticMesh* Mesh = RestCollection->AutoInstanceMeshes[MeshIndex].Mesh)
+		{
+			InstancesByMesh.FindOrAdd(Mesh).Add(FTransform(Transforms[i]) * ComponentTransform);
+		}
+	}
+
+	for (TPair<UStaticMesh*, TArray<FTransform>>& Pair : InstancesByMesh)
+	{
+		FDebrisMeshBatch& Batch = FindOrAddBatch(Pair.Key);
+		Batch.Instances->AddInstances(Pair.Value, false, true);
+		Batch.Owners.Reserve(Batch.Owners.Num() + Pair.Value.Num());
+		for (int32 i = 0; i < Pair.Value.Num(); ++i)
+		{
+			Batch.Owners.Add(TrackedIndex);
+		}
+		m_NumBakedInstances += Pair.Value.Num();
+	}
+
+	// The collection stays around hidden, its particles are removed from the solver until it is woken
+	Debris.Collision = Component->GetCollisionEnabled();
+	Component->SetSimulatePhysics(false);
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->DestroyPhysicsState();
+	Component->SetVisibility(false);
+
+	Debris.bBaked = true;
+	return true;
+}
+
+void UDebrisBakeSubsystem::Wake(int32 TrackedIndex)
+{
+	FTrackedDebris& Debris = m_Tracked[TrackedIndex];
+	if (!Debris.bBaked)
+	{
+		return;
+	}
+
+	PHYSICS_HITCH_SCOPE(DebrisWake, GetWorld());
+
+	for (TPair<TObjectPtr<UStaticMesh>, FDebrisMeshBatch>& Pair : m_Batches)
+	{
+		FDebrisMeshBatch& Batch = Pair.Value;
+		TArray<int32> Removed;
+		for (int32 i = Batch.Owners.Num() - 1; i >= 0; --i)
+		{
+			if (Batch.Owners[i] == TrackedIndex)
+			{
+				Removed.Add(i);
+				// Instance removal keeps the order of the remaining instances, so the owners do the same
+				Batch.Owners.RemoveAt(i, 1, EAllowShrinking::No);
+			}
+		}
+		if (Removed.Num() && Batch.Instances.IsValid())
+		{
+			Batch.Instances->RemoveInstances(Removed);
+			m_NumBakedInstances -= Removed.Num();
+		}
+	}
+
+	if (UGeometryCollectionComponent* Component = Debris.Component.Get())
+	{
+		// The new proxy starts from the collection's current transforms, where the fragments were baked
+		Component->SetVisibility(true);
+		Component->SetCollisionEnabled(Debris.Collision);
+		Component->SetSimulatePhysics(true);
+		Component->RecreatePhysicsState();
+		Component->WakeAllRigidBodies();
+	}
+
+	Debris.bBaked = false;
+	Debris.StillTime = 0.f;
+	Debris.LastPositions.Reset();
+	UpdateStats();
+}
+
+int32 UDebrisBakeSubsystem::FindOwner(const UPrimitiveComponent* Component, int32 Item) const
+{
+	if (!m_BakeActor || !Component || Component->GetOwner() != m_BakeActor)
+	{
+		return INDEX_NONE;
+	}
+
+	for (const TPair<TObjectPtr<UStaticMesh>, FDebrisMeshBatch>& Pair : m_Batches)
+	{
+		const FDebrisMeshBatch& Batch = Pair.Value;
+		if (Batch.Instances.Get() == Component && Batch.Owners.IsValidIndex(Item))
+		{
+			return Batch.Owners[Item];
+		}
+	}
+	return INDEX_NONE;
+}
+
+ABreakableTarget* UDebrisBakeSubsystem::WakeFromHit(const FHitResult& Hit)
+{
+	const int32 TrackedIndex = FindOwner(Hit.GetComponent(), Hit.Item);
+	if (TrackedIndex == INDEX_NONE)
+	{
+		return nullptr;
+	}
+	Wake(TrackedIndex);
+	return m_Tracked[TrackedIndex].Target.Get();
+}
+
+bool UDebrisBakeSubsystem::WakeFromOverlaps(const TArray<FOverlapResult>& Overlaps)
+{
+	// Owners are gathered first, waking removes instances and shifts the item indices of the remaining overlaps
+	TSet<int32> ToWake;
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		const int32 TrackedIndex = FindOwner(Overlap.GetComponent(), Overlap.ItemIndex);
+		if (TrackedIndex != INDEX_NONE)
+		{
+			ToWake.Add(TrackedIndex);
+		}
+	}
+
+	for (const int32 TrackedIndex : ToWake)
+	{
+		Wake(TrackedIndex);
+	}
+	return !ToWake.IsEmpty();
+}
+
+void UDebrisBakeSubsystem::WakeInRadius(const FVector& Location, float Radius)
+{
+	TSet<int32> ToWake;
+	for (TPair<TObjectPtr<UStaticMesh>, FDebrisMeshBatch>& Pair : m_Batches)
+	{
+		FDebrisMeshBatch& Batch = Pair.Value;
+		if (!Batch.Instances.IsValid())
+		{
+			continue;
+		}
+		for (const int32 Instance : Batch.Instances->GetInstancesOverlappingSphere(Location, Radius, true))
+		{
+			ToWake.Add(Batch.Owners[Instance]);
+		}
+	}
+
+	for (const int32 TrackedIndex : ToWake)
+	{
+		Wake(TrackedIndex);
+	}
+}
+
+void UDebrisBakeSubsystem::Untrack(ABreakableTarget* Target)
+{
+	for (int32 i = 0; i < m_Tracked.Num(); ++i)
+	{
+		FTrackedDebris& Debris = m_Tracked[i];
+		if (Debris.Target.Get() != Target)
+		{
+			continue;
+		}
+
+		Wake(i);
+		FreeSlot(i);
+	}
+	UpdateStats();
+}
+
+void UDebrisBakeSubsystem::FreeSlot(int32 TrackedIndex)
+{
+	// Only called once the debris has no instance left, no batch owner points at the slot when it is reused
+	m_Tracked[TrackedIndex] = FTrackedDebris();
+	m_FreeSlots.Add(TrackedIndex);
+}
+
+int32 UDebrisBakeSubsystem::GetNumActiveParticles() const
+{
+	return m_ParticleCounts ? m_ParticleCounts->NumActive.load(std::memory_order_relaxed) : 0;
+}
+
+int32 UDebrisBakeSubsystem::GetNumDynamicParticles() const
+{
+	return m_ParticleCounts ? m_ParticleCounts->NumDynamic.load(std::memory_order_relaxed) : 0;
+}
+
+void UDebrisBakeSubsystem::UpdateStats() const
+{
+	SET_DWORD_STAT(STAT_SolverActiveParticles, GetNumActiveParticles());
+	SET_DWORD_STAT(STAT_SolverDynamicParticles, GetNumDynamicParticles());
+	SET_DWORD_STAT(STAT_DebrisBakedInstances, m_NumBakedInstances);
+}
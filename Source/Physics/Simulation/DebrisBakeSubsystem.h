@@ -0,0 +1,119 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineTypes.h"
+#include "DebrisBakeSubsystem.generated.h"
+
+class FDebrisParticleCountCallback;
+class ABreakableTarget;
+class UGeometryCollectionComponent;
+class UPrimitiveComponent;
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+struct FOverlapResult;
+
+/**
+ * Takes the debris of broken targets out of the Chaos simulation once it has settled.
+ * Settled fragments are re-emitted as instances of one shared UInstancedStaticMeshComponent per fragment mesh,
+ * their collection's physics state is destroyed so its particles leave the solver,
+ * and they are turned back into live bodies when a grab trace, a telekinesis grab, a shot or an explosion touches them.
+ * Fragment meshes come from the auto instance meshes of the rest collection, collections fractured without them are left alone.
+ */
+UCLASS(config=Game)
+class PHYSICS_API UDebrisBakeSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Seconds between two settle checks */
+	UPROPERTY(config)
+	float m_CheckInterval = 0.5f;
+
+	/** Seconds every fragment of a target must stay still before it is baked */
+	UPROPERTY(config)
+	float m_SleepTimeout = 3.f;
+
+	/** Fragment displacement under which a fragment counts as still, in cm per check */
+	UPROPERTY(config)
+	float m_SleepTolerance = 0.5f;
+
+	/** USubsystem **/
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** UWorldSubsystem **/
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** FTickableGameObject **/
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Turns the baked debris hit by this trace back into live bodies, returns the target it belonged to */
+	ABreakableTarget* WakeFromHit(const FHitResult& Hit);
+
+	/** Turns the baked debris with an instance in these overlaps back into live bodies, returns true if any was woken */
+	bool WakeFromOverlaps(const TArray<FOverlapResult>& Overlaps);
+
+	/** Turns every baked debris with an instance inside the sphere back into live bodies */
+	void WakeInRadius(const FVector& Location, float Radius);
+
+	/** Forgets a target, waking its debris first, used when a target is reset */
+	void Untrack(ABreakableTarget* Target);
+
+	/** Particles of the whole solver, read at the start of the last physics step */
+	int32 GetNumActiveParticles() const;
+	int32 GetNumDynamicParticles() const;
+	int32 GetNumBakedInstances() const { return m_NumBakedInstances; }
+
+protected:
+	UFUNCTION()
+	void OnTargetBroken(ABreakableTarget* Target);
+
+	struct FTrackedDebris
+	{
+		TWeakObjectPtr<ABreakableTarget> Target;
+		TWeakObjectPtr<UGeometryCollectionComponent> Component;
+		TArray<FVector> LastPositions;
+		float StillTime = 0.f;
+		/** Collision of the collection before it was baked, restored when woken */
+		TEnumAsByte<ECollisionEnabled::Type> Collision = ECollisionEnabled::QueryAndPhysics;
+		bool bBaked = false;
+	};
+
+	struct FDebrisMeshBatch
+	{
+		TWeakObjectPtr<UInstancedStaticMeshComponent> Instances;
+		/** Index in m_Tracked of the debris each instance belongs to */
+		TArray<int32> Owners;
+	};
+
+	/** Returns true once every fragment of the debris has been still for m_SleepTimeout */
+	bool UpdateSettled(FTrackedDebris& Debris);
+
+	bool Bake(int32 TrackedIndex);
+	void Wake(int32 TrackedIndex);
+
+	/** Index in m_Tracked of the debris a bake instance belongs to, INDEX_NONE for anything else */
+	int32 FindOwner(const UPrimitiveComponent* Component, int32 Item) const;
+
+	/** Empties a tracked slot and hands it to the next broken target */
+	void FreeSlot(int32 TrackedIndex);
+
+	FDebrisMeshBatch& FindOrAddBatch(UStaticMesh* Mesh);
+	void UpdateStats() const;
+
+	FDebrisParticleCountCallback* m_ParticleCounts = nullptr;
+
+	UPROPERTY()
+	AActor* m_BakeActor;
+
+	/** Slots are reused through m_FreeSlots rather than removed, instance owners keep pointing at stable indices */
+	TArray<FTrackedDebris> m_Tracked;
+	TArray<int32> m_FreeSlots;
+	TMap<TObjectPtr<UStaticMesh>, FDebrisMeshBatch> m_Batches;
+
+	float m_TimeToCheck = 0.f;
+	int32 m_NumBakedInstances = 0;
+};
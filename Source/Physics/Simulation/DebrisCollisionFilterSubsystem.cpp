@@ -0,0 +1,179 @@
+#include "Simulation/DebrisCollisionFilterSubsystem.h"
+#include "BreakableTarget.h"
+#include "PhysicsStats.h"
+#include "Engine/CollisionProfile.h"
+#include "GeometryCollection/GeometryCollection.h"
+#include "GeometryCollection/GeometryCollectionComponent.h"
+#include "GeometryCollection/GeometryCollectionObject.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Debris Collision Filter"), STAT_DebrisCollisionFilter, STATGROUP_PhysicsGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Debris Static Only"), STAT_DebrisStaticOnly, STATGROUP_PhysicsGame);
+
+static TAutoConsoleVariable<bool> CVarDebrisCollisionFilter(
+	TEXT("Physics.DebrisCollisionFilter"),
+	true,
+	TEXT("Filter what fracture debris collides with. Read when a target collection registers and when a target breaks."));
+
+namespace
+{
+	/** Largest fragment bounds of the rest collection, in collection space */
+	float GetMaxFragmentSize(const UGeometryCollectionComponent& Component)
+	{
+		const UGeometryCollection* RestCollection = Component.GetRestCollection();
+		const TSharedPtr<FGeometryCollection, ESPMode::ThreadSafe> Collection = RestCollection ? RestCollection->GetGeometryCollection() : nullptr;
+		if (!Collection)
+		{
+			return TNumericLimits<float>::Max();
+		}
+
+		double MaxSize = 0.0;
+		for (const FBox& Bounds : Collection->BoundingBox)
+		{
+			MaxSize = FMath::Max(MaxSize, Bounds.GetSize().GetMax());
+		}
+		return static_cast<float>(MaxSize);
+	}
+}
+
+bool UDebrisCollisionFilterSubsystem::IsEnabled()
+{
+	return CVarDebrisCollisionFilter.GetValueOnGameThread();
+}
+
+int32 UDebrisCollisionFilterSubsystem::GetCollisionGroup(const ABreakableTarget* Target)
+{
+	// Chaos pairs particles of group 0 with everything and never pairs two different non zero groups
+	return FMath::Max(static_cast<int32>(Target->GetUniqueID() & MAX_int32), 1);
+}
+
+bool UDebrisCollisionFilterSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UDebrisCollisionFilterSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	FCollisionResponseTemplate ProjectileProfile;
+	if (UCollisionProfile::Get()->GetProfileTemplate(TEXT("Projectile"), ProjectileProfile))
+	{
+		m_ProjectileChannel = ProjectileProfile.ObjectType;
+	}
+
+	ABreakableTarget::OnBreakTarget.AddDynamic(this, &UDebrisCollisionFilterSubsystem::OnTargetBroken);
+}
+
+void UDebrisCollisionFilterSubsystem::Deinitialize()
+{
+	ABreakableTarget::OnBreakTarget.RemoveDynamic(this, &UDebrisCollisionFilterSubsystem::OnTargetBroken);
+
+	Super::Deinitialize();
+}
+
+TStatId UDebrisCollisionFilterSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDebrisCollisionFilterSubsystem, STATGROUP_Tickables);
+}
+
+void UDebrisCollisionFilterSubsystem::OnTargetBroken(ABreakableTarget* Target)
+{
+	if (!IsEnabled() || !Target || Target->GetWorld() != GetWorld() || !Target->GeometryCollection)
+	{
+		return;
+	}
+
+	const float Scale = static_cast<float>(Target->GeometryCollection->GetComponentScale().GetMax());
+
+	FTrackedDebris& Debris = m_Tracked.AddDefaulted_GetRef();
+	Debris.Target = Target;
+	Debris.Component = Target->GeometryCollection;
+	Debris.bSmall = GetMaxFragmentSize(*Target->GeometryCollection) * Scale < m_StaticOnlySize;
+}
+
+void UDebrisCollisionFilterSubsystem::Untrack(ABreakableTarget* Target)
+{
+	const int32 NumStaticOnlyBefore = m_NumStaticOnly;
+	m_Tracked.RemoveAllSwap([this, Target](const FTrackedDebris& Debris)
+	{
+		const bool bRemove = Debris.Target == Target;
+		m_NumStaticOnly -= bRemove && Debris.Stage == EDebrisStage::StaticOnly ? 1 : 0;
+		return bRemove;
+	});
+	if (NumStaticOnlyBefore != m_NumStaticOnly)
+	{
+		SET_DWORD_STAT(STAT_DebrisStaticOnly, m_NumStaticOnly);
+	}
+}
+
+void UDebrisCollisionFilterSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	m_TimeToCheck -= DeltaTime;
+	if (m_TimeToCheck > 0.f)
+	{
+		return;
+	}
+	const float Elapsed = m_CheckInterval - m_TimeToCheck;
+	m_TimeToCheck = m_CheckInterval;
+
+	SCOPE_CYCLE_COUNTER(STAT_DebrisCollisionFilter);
+
+	for (int32 i = m_Tracked.Num() - 1; i >= 0; --i)
+	{
+		FTrackedDebris& Debris = m_Tracked[i];
+		UGeometryCollectionComponent* Component = Debris.Component.Get();
+		if (!Component)
+		{
+			m_NumStaticOnly -= Debris.Stage == EDebrisStage::StaticOnly ? 1 : 0;
+			m_Tracked.RemoveAtSwap(i);
+			continue;
+		}
+
+		Debris.Age += Elapsed;
+		const float MaxSpeed = UpdateMaxSpeed(Debris, Elapsed);
+
+		if (Debris.Stage == EDebrisStage::Live && Debris.Age >= m_ProjectileWindow)
+		{
+			Component->SetCollisionResponseToChannel(m_ProjectileChannel, ECR_Ignore);
+			Debris.Stage = EDebrisStage::NoProjectiles;
+		}
+		if (Debris.Stage == EDebrisStage::NoProjectiles && (Debris.bSmall || MaxSpeed < m_StaticOnlySpeed))
+		{
+			SetStaticOnly(*Component);
+			Debris.Stage = EDebrisStage::StaticOnly;
+			++m_NumStaticOnly;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_DebrisStaticOnly, m_NumStaticOnly);
+}
+
+float UDebrisCollisionFilterSubsystem::UpdateMaxSpeed(FTrackedDebris& Debris, float Elapsed) const
+{
+	const auto& Transforms = Debris.Component->GetComponentSpaceTransforms();
+
+	// No speed before the second check, the debris counts as moving
+	float MaxDistSquared = Debris.LastPositions.Num() == Transforms.Num() ? 0.f : TNumericLimits<float>::Max();
+	Debris.LastPositions.SetNum(Transforms.Num());
+	for (int32 i = 0; i < Transforms.Num(); ++i)
+	{
+		const FVector Position(Transforms[i].GetTranslation());
+		MaxDistSquared = FMath::Max(MaxDistSquared, static_cast<float>(FVector::DistSquared(Position, Debris.LastPositions[i])));
+		Debris.LastPositions[i] = Position;
+	}
+	return MaxDistSquared == TNumericLimits<float>::Max() ? MaxDistSquared : FMath::Sqrt(MaxDistSquared) / FMath::Max(Elapsed, UE_SMALL_NUMBER);
+}
+
+void UDebrisCollisionFilterSubsystem::SetStaticOnly(UGeometryCollectionComponent& Component)
+{
+	FCollisionResponseContainer Responses(ECR_Ignore);
+	Responses.SetResponse(ECC_WorldStatic, ECR_Block);
+	// Query only channels, kept for the grab and debris wake traces
+	Responses.SetResponse(ECC_Visibility, Component.GetCollisionResponseToChannel(ECC_Visibility));
+	Responses.SetResponse(ECC_Camera, Component.GetCollisionResponseToChannel(ECC_Camera));
+	Component.SetCollisionResponseToChannels(Responses);
+}
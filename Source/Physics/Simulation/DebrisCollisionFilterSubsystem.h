@@ -0,0 +1,93 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DebrisCollisionFilterSubsystem.generated.h"
+
+class ABreakableTarget;
+class UGeometryCollectionComponent;
+
+/**
+ * Narrows what fracture debris collides with, so broken targets stop multiplying the Chaos collision pairs:
+ * - every target collection gets its own Chaos collision group, fragments of different targets never pair up
+ * - projectiles stop seeing the debris m_ProjectileWindow seconds after the break
+ * - after that window, debris made of small fragments, or that slowed down, only collides with static geometry
+ * The last two go through the component collision responses, which update the filter data of the Chaos particles.
+ * Visibility and camera traces are never filtered so grabbing and debris waking keep working.
+ * Toggle with Physics.DebrisCollisionFilter to compare the pair counts in the soak report.
+ */
+UCLASS(config=Game)
+class PHYSICS_API UDebrisCollisionFilterSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Seconds after a break during which projectiles still hit the debris */
+	UPROPERTY(config)
+	float m_ProjectileWindow = 0.5f;
+
+	/** Debris whose largest fragment is smaller than this goes static only right after the projectile window, in cm */
+	UPROPERTY(config)
+	float m_StaticOnlySize = 30.f;
+
+	/** Debris whose fastest fragment is slower than this goes static only, in cm/s */
+	UPROPERTY(config)
+	float m_StaticOnlySpeed = 50.f;
+
+	/** Seconds between two fragment speed checks */
+	UPROPERTY(config)
+	float m_CheckInterval = 0.25f;
+
+	/** Whether Physics.DebrisCollisionFilter is set */
+	static bool IsEnabled();
+
+	/** Chaos collision group unique to a target, set on its collection before it registers */
+	static int32 GetCollisionGroup(const ABreakableTarget* Target);
+
+	/** USubsystem **/
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** FTickableGameObject **/
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override { return !m_Tracked.IsEmpty(); }
+
+	/** Forgets a target, used when a target is reset */
+	void Untrack(ABreakableTarget* Target);
+
+	int32 GetNumStaticOnly() const { return m_NumStaticOnly; }
+
+protected:
+	UFUNCTION()
+	void OnTargetBroken(ABreakableTarget* Target);
+
+	enum class EDebrisStage : uint8
+	{
+		Live,
+		NoProjectiles,
+		StaticOnly
+	};
+
+	struct FTrackedDebris
+	{
+		TWeakObjectPtr<ABreakableTarget> Target;
+		TWeakObjectPtr<UGeometryCollectionComponent> Component;
+		TArray<FVector> LastPositions;
+		float Age = 0.f;
+		bool bSmall = false;
+		EDebrisStage Stage = EDebrisStage::Live;
+	};
+
+	/** Fastest fragment since the last check, in cm/s */
+	float UpdateMaxSpeed(FTrackedDebris& Debris, float Elapsed) const;
+
+	void SetStaticOnly(UGeometryCollectionComponent& Component);
+
+	TArray<FTrackedDebris> m_Tracked;
+	TEnumAsByte<ECollisionChannel> m_ProjectileChannel = ECC_WorldDynamic;
+
+	float m_TimeToCheck = 0.f;
+	int32 m_NumStaticOnly = 0;
+};
@@ -0,0 +1,213 @@
+#include "Simulation/PhysicsDeterminism.h"
+#include "PhysicsCharacter.h"
+#include "PhysicsProjectile.h"
+#include "Chaos/SimCallbackObject.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PhysicsEngine/PhysicsSettings.h"
+#include "PBDRigidsSolver.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPhysicsDeterminism, Log, All);
+
+/** Game thread state pushed every frame, hashed together with the solver state of the step consuming it */
+struct FDeterminismGameplayInput : public Chaos::FSimCallbackInput
+{
+	uint32 GameplayChecksum = 0;
+
+	void Reset()
+	{
+		GameplayChecksum = 0;
+	}
+};
+
+/** Hashes the solver state at the start of every checksum step, on the physics thread */
+class FDeterminismChecksumCallback : public Chaos::TSimCallbackObject<FDeterminismGameplayInput>
+{
+public:
+	/** Moves the checksums computed since the last call, keyed by solver step, game thread only */
+	void PopChecksums(TArray<TPair<int32, uint32>>& OutChecksums)
+	{
+		FScopeLock Lock(&m_Lock);
+		OutChecksums.Append(MoveTemp(m_Checksums));
+		m_Checksums.Reset();
+	}
+
+private:
+	virtual void OnPreSimulate_Internal() override
+	{
+		Chaos::FPBDRigidsSolver* Solver = static_cast<Chaos::FPBDRigidsSolver*>(GetSolver());
+		const int32 Step = Solver->GetCurrentFrame();
+		if (Step % FPhysicsDeterminism::GetChecksumInterval() != 0)
+		{
+			return;
+		}
+
+		const FDeterminismGameplayInput* Input = GetConsumerInput();
+		const uint32 Checksum = UPhysicsDeterminismSubsystem::ComputeStateChecksum(*Solver) + (Input ? Input->GameplayChecksum : 0);
+		FScopeLock Lock(&m_Lock);
+		m_Checksums.Emplace(Step, Checksum);
+	}
+
+	FCriticalSection m_Lock;
+	TArray<TPair<int32, uint32>> m_Checksums;
+};
+
+void FPhysicsDeterminism::ConfigureFromCommandLine()
+{
+	const TCHAR* CommandLine = FCommandLine::Get();
+	bEnabled = FParse::Param(CommandLine, TEXT("PhysicsDeterministic"));
+	if (!bEnabled)
+	{
+		return;
+	}
+
+	float StepRate = 60.f;
+	FParse::Value(CommandLine, TEXT("PhysicsFixedHz="), StepRate);
+	FParse::Value(CommandLine, TEXT("PhysicsSeed="), SessionSeed);
+	FParse::Value(CommandLine, TEXT("PhysicsChecksumEvery="), ChecksumInterval);
+	FixedDeltaTime = 1.0 / FMath::Max(StepRate, 1.f);
+	ChecksumInterval = FMath::Max(ChecksumInterval, 1);
+
+	// Every tick advances gameplay (projectile movement, grab interpolation, stamina, fire schedule) by exactly one step
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(FixedDeltaTime);
+
+	// Chaos runs on its own thread at the same fixed step, the game thread sees results interpolated between steps
+	UPhysicsSettings* PhysicsSettings = UPhysicsSettings::Get();
+	PhysicsSettings->bTickPhysicsAsync = true;
+	PhysicsSettings->AsyncFixedTimeStepSize = static_cast<float>(FixedDeltaTime);
+	PhysicsSettings->bSubstepping = false;
+
+	FMath::RandInit(SessionSeed);
+	FMath::SRandInit(SessionSeed);
+
+	UE_LOG(LogPhysicsDeterminism, Display, TEXT("Deterministic mode: %.1f Hz, seed %d, checksum every %d steps"), 1.0 / FixedDeltaTime, SessionSeed, ChecksumInterval);
+}
+
+bool UPhysicsDeterminismSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return FPhysicsDeterminism::IsEnabled() && World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UPhysicsDeterminismSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	m_OutputPath = FPaths::ProjectSavedDir() / TEXT("Determinism") / FString::Printf(TEXT("Checksums_Seed%d_%s.csv"), FPhysicsDeterminism::GetSessionSeed(), *FDateTime::Now().ToString());
+	FFileHelper::SaveStringToFile(TEXT("step,checksum\n"), *m_OutputPath);
+
+	FPhysScene* Scene = InWorld.GetPhysicsScene();
+	if (Chaos::FPBDRigidsSolver* Solver = Scene ? Scene->GetSolver() : nullptr)
+	{
+		m_Callback = Solver->CreateAndRegisterSimCallbackObject_External<FDeterminismChecksumCallback>();
+	}
+}
+
+void UPhysicsDeterminismSubsystem::Deinitialize()
+{
+	if (m_Callback)
+	{
+		if (Chaos::FPBDRigidsSolver* Solver = static_cast<Chaos::FPBDRigidsSolver*>(m_Callback->GetSolver()))
+		{
+			Solver->UnregisterAndFreeSimCallbackObject_External(m_Callback);
+		}
+		m_Callback = nullptr;
+	}
+
+	Super::Deinitialize();
+}
+
+void UPhysicsDeterminismSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!m_Callback)
+	{
+		return;
+	}
+
+	// Consumed by the step started next frame, one frame per step with the fixed game step
+	if (FDeterminismGameplayInput* Input = m_Callback->GetProducerInputData_External())
+	{
+		Input->GameplayChecksum = ComputeGameplayChecksum(*GetWorld());
+	}
+
+	TArray<TPair<int32, uint32>> Checksums;
+	m_Callback->PopChecksums(Checksums);
+	if (Checksums.IsEmpty())
+	{
+		return;
+	}
+
+	FString Lines;
+	for (const TPair<int32, uint32>& Checksum : Checksums)
+	{
+		UE_LOG(LogPhysicsDeterminism, Log, TEXT("Step %d checksum %08x"), Checksum.Key, Checksum.Value);
+		Lines += FString::Printf(TEXT("%d,%08x\n"), Checksum.Key, Checksum.Value);
+	}
+	m_LastChecksum = Checksums.Last().Value;
+	FFileHelper::SaveStringToFile(Lines, *m_OutputPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
+
+TStatId UPhysicsDeterminismSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPhysicsDeterminismSubsystem, STATGROUP_Tickables);
+}
+
+uint32 UPhysicsDeterminismSubsystem::ComputeStateChecksum(Chaos::FPBDRigidsSolver& Solver)
+{
+	// Particle storage order depends on activation history, so particle hashes are summed instead of chained
+	uint32 Checksum = 0;
+	for (const auto& Particle : Solver.GetParticles().GetNonDisabledDynamicView())
+	{
+		uint32 Crc = 0;
+		auto HashValue = [&Crc](const auto& Value)
+		{
+			Crc = FCrc::MemCrc32(&Value, sizeof(Value), Crc);
+		};
+		HashValue(Particle.GetX());
+		HashValue(Particle.GetR());
+		HashValue(Particle.GetV());
+		HashValue(Particle.GetW());
+		Checksum += Crc;
+	}
+	return Checksum;
+}
+
+uint32 UPhysicsDeterminismSubsystem::ComputeGameplayChecksum(UWorld& World)
+{
+	// Summed per actor like the particles, so spawn order and memory order do not matter
+	uint32 Checksum = 0;
+	for (TActorIterator<APhysicsCharacter> It(&World); It; ++It)
+	{
+		uint32 Crc = 0;
+		auto HashValue = [&Crc](const auto& Value)
+		{
+			Crc = FCrc::MemCrc32(&Value, sizeof(Value), Crc);
+		};
+		HashValue(It->GetActorLocation());
+		HashValue(It->GetActorRotation());
+		HashValue(It->GetVelocity());
+		HashValue(It->GetStamina());
+		HashValue(It->GetHealth());
+		Checksum += Crc;
+	}
+	for (TActorIterator<APhysicsProjectile> It(&World); It; ++It)
+	{
+		uint32 Crc = 0;
+		auto HashValue = [&Crc](const auto& Value)
+		{
+			Crc = FCrc::MemCrc32(&Value, sizeof(Value), Crc);
+		};
+		HashValue(It->GetActorLocation());
+		HashValue(It->GetVelocity());
+		Checksum += Crc;
+	}
+	return Checksum;
+}
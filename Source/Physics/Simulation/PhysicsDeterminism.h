@@ -0,0 +1,72 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PhysicsDeterminism.generated.h"
+
+class FDeterminismChecksumCallback;
+
+namespace Chaos
+{
+	class FPBDRigidsSolver;
+}
+
+/**
+ * Session wide settings of the deterministic simulation mode, enabled with -PhysicsDeterministic.
+ *   -PhysicsFixedHz=60          game frame and Chaos step rate, every frame advances gameplay and physics by one step
+ *   -PhysicsSeed=1              seed every random stream of the session derives from
+ *   -PhysicsChecksumEvery=60    steps between two state checksums
+ */
+struct PHYSICS_API FPhysicsDeterminism
+{
+	/** Reads the command line and switches the game frame and Chaos to fixed steps, must run before the first world is created */
+	static void ConfigureFromCommandLine();
+
+	static bool IsEnabled() { return bEnabled; }
+	static int32 GetSessionSeed() { return SessionSeed; }
+	static double GetFixedDeltaTime() { return FixedDeltaTime; }
+	static int32 GetChecksumInterval() { return ChecksumInterval; }
+
+private:
+	static inline bool bEnabled = false;
+	static inline int32 SessionSeed = 1;
+	static inline double FixedDeltaTime = 1.0 / 60.0;
+	static inline int32 ChecksumInterval = 60;
+};
+
+/**
+ * Emits a checksum of the simulated state every FPhysicsDeterminism::GetChecksumInterval() solver steps,
+ * to Saved/Determinism, so two runs can be proven to have simulated the same workload.
+ * Particles are hashed on the physics thread at the start of the step, never from interpolated game thread transforms.
+ * Characters and projectiles are hashed on the game thread and handed to that step through the sim callback input.
+ */
+UCLASS()
+class PHYSICS_API UPhysicsDeterminismSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** USubsystem **/
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/** UWorldSubsystem **/
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	/** FTickableGameObject **/
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Checksum of every dynamic particle of the solver, physics thread only. Independent of particle order */
+	static uint32 ComputeStateChecksum(Chaos::FPBDRigidsSolver& Solver);
+
+	/** Checksum of the characters (transform, velocity, stamina, health) and live projectiles, game thread only */
+	static uint32 ComputeGameplayChecksum(UWorld& World);
+
+	uint32 GetLastChecksum() const { return m_LastChecksum; }
+
+protected:
+	FString m_OutputPath;
+	FDeterminismChecksumCallback* m_Callback = nullptr;
+	uint32 m_LastChecksum = 0;
+};
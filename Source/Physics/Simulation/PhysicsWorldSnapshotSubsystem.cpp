@@ -0,0 +1,246 @@
+#include "Simulation/PhysicsWorldSnapshotSubsystem.h"
+#include "BreakableTarget.h"
+#include "PhysicsCharacter.h"
+#include "PhysicsProjectile.h"
+#include "Weapons/PhysicsWeaponComponent.h"
+#include "Profiling/PhysicsHitchDetector.h"
+#include "EngineUtils.h"
+#include "TimerManager.h"
+#include "Components/PrimitiveComponent.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "GeometryCollection/GeometryCollectionComponent.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPhysicsSnapshot, Log, All);
+
+namespace
+{
+	constexpr uint32 SnapshotMagic = 0x50534E50; // 'PSNP'
+	constexpr uint32 SnapshotVersion = 2;
+
+	/** Body state, float precision is enough for everything but the location */
+	struct FBodyRecord
+	{
+		FVector Location;
+		FQuat4f Rotation;
+		FVector3f LinearVelocity;
+		FVector3f AngularVelocity;
+
+		friend FArchive& operator<<(FArchive& Ar, FBodyRecord& Record)
+		{
+			return Ar << Record.Location << Record.Rotation << Record.LinearVelocity << Record.AngularVelocity;
+		}
+	};
+
+	/** Character state on top of its body, the control rotation drives the view and the aim */
+	struct FCharacterRecord
+	{
+		FBodyRecord Body;
+		FRotator3f ControlRotation;
+		float Health;
+		float Stamina;
+
+		friend FArchive& operator<<(FArchive& Ar, FCharacterRecord& Record)
+		{
+			return Ar << Record.Body << Record.ControlRotation << Record.Health << Record.Stamina;
+		}
+	};
+}
+
+bool UPhysicsWorldSnapshotSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UPhysicsWorldSnapshotSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Actors run their BeginPlay after the subsystems are notified, so capture once they all have
+	InWorld.GetTimerManager().SetTimerForNextTick(this, &UPhysicsWorldSnapshotSubsystem::Capture);
+}
+
+void UPhysicsWorldSnapshotSubsystem::Capture()
+{
+	m_Data.Reset();
+	m_Bodies.Reset();
+	m_Targets.Reset();
+	m_Characters.Reset();
+	m_ProjectileClasses.Reset();
+	m_ProjectileWeapons.Reset();
+
+	UWorld* World = GetWorld();
+	TArray<APhysicsProjectile*> Projectiles;
+	TArray<UPrimitiveComponent*> Primitives;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		AActor* Actor = *It;
+		if (ABreakableTarget* Target = Cast<ABreakableTarget>(Actor))
+		{
+			m_Targets.Add(Target);
+			continue;
+		}
+		if (APhysicsCharacter* Character = Cast<APhysicsCharacter>(Actor))
+		{
+			m_Characters.Add(Character);
+			continue;
+		}
+		if (APhysicsProjectile* Projectile = Cast<APhysicsProjectile>(Actor))
+		{
+			Projectiles.Add(Projectile);
+			m_ProjectileClasses.Add(Projectile->GetClass());
+			m_ProjectileWeapons.Add(Projectile->m_OwnerWeapon);
+			continue;
+		}
+
+		Actor->GetComponents(Primitives);
+		for (UPrimitiveComponent* Primitive : Primitives)
+		{
+			if (Primitive->IsSimulatingPhysics() && !Primitive->IsA<UGeometryCollectionComponent>())
+			{
+				m_Bodies.Add(Primitive);
+			}
+		}
+	}
+
+	FMemoryWriter Writer(m_Data);
+	uint32 Magic = SnapshotMagic;
+	uint32 Version = SnapshotVersion;
+	int32 NumBodies = m_Bodies.Num();
+	int32 NumTargets = m_Targets.Num();
+	int32 NumCharacters = m_Characters.Num();
+	int32 NumProjectiles = m_ProjectileClasses.Num();
+	Writer << Magic << Version << NumBodies << NumTargets << NumCharacters << NumProjectiles;
+
+	for (const TWeakObjectPtr<UPrimitiveComponent>& Body : m_Bodies)
+	{
+		FBodyRecord Record;
+		Record.Location = Body->GetComponentLocation();
+		Record.Rotation = FQuat4f(Body->GetComponentQuat());
+		Record.LinearVelocity = FVector3f(Body->GetPhysicsLinearVelocity());
+		Record.AngularVelocity = FVector3f(Body->GetPhysicsAngularVelocityInDegrees());
+		Writer << Record;
+	}
+
+	// One bit per target, packed in bytes
+	TArray<uint8> BrokenBits;
+	BrokenBits.SetNumZeroed((NumTargets + 7) / 8);
+	for (int32 i = 0; i < NumTargets; ++i)
+	{
+		if (m_Targets[i]->m_IsBroken)
+		{
+			BrokenBits[i / 8] |= 1 << (i % 8);
+		}
+	}
+	Writer.Serialize(BrokenBits.GetData(), BrokenBits.Num());
+
+	for (const TWeakObjectPtr<APhysicsCharacter>& Character : m_Characters)
+	{
+		FCharacterRecord Record;
+		Record.Body.Location = Character->GetActorLocation();
+		Record.Body.Rotation = FQuat4f(Character->GetActorQuat());
+		Record.Body.LinearVelocity = FVector3f(Character->GetVelocity());
+		Record.Body.AngularVelocity = FVector3f::ZeroVector;
+		Record.ControlRotation = FRotator3f(Character->GetControlRotation());
+		Record.Health = Character->GetHealth();
+		Record.Stamina = Character->GetStamina();
+		Writer << Record;
+	}
+
+	for (const APhysicsProjectile* Projectile : Projectiles)
+	{
+		FBodyRecord Record;
+		Record.Location = Projectile->GetActorLocation();
+		Record.Rotation = FQuat4f(Projectile->GetActorQuat());
+		Record.LinearVelocity = FVector3f(Projectile->GetVelocity());
+		Record.AngularVelocity = FVector3f::ZeroVector;
+		Writer << Record;
+	}
+
+	UE_LOG(LogPhysicsSnapshot, Log, TEXT("Snapshot captured: %d bodies, %d targets, %d characters, %d projectiles, %d bytes"),
+		NumBodies, NumTargets, NumCharacters, NumProjectiles, m_Data.Num());
+}
+
+bool UPhysicsWorldSnapshotSubsystem::Restore()
+{
+	if (m_Data.IsEmpty())
+	{
+		return false;
+	}
+
+	PHYSICS_HITCH_SCOPE(SnapshotRestore, GetWorld());
+
+	const double StartTime = FPlatformTime::Seconds();
+	UWorld* World = GetWorld();
+
+	FMemoryReader Reader(m_Data);
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	int32 NumBodies = 0;
+	int32 NumTargets = 0;
+	int32 NumCharacters = 0;
+	int32 NumProjectiles = 0;
+	Reader << Magic << Version << NumBodies << NumTargets << NumCharacters << NumProjectiles;
+	check(Magic == SnapshotMagic && Version == SnapshotVersion);
+
+	for (int32 i = 0; i < NumBodies; ++i)
+	{
+		FBodyRecord Record;
+		Reader << Record;
+		if (UPrimitiveComponent* Body = m_Bodies[i].Get())
+		{
+			Body->SetWorldLocationAndRotation(Record.Location, FQuat(Record.Rotation), false, nullptr, ETeleportType::ResetPhysics);
+			Body->SetPhysicsLinearVelocity(FVector(Record.LinearVelocity));
+			Body->SetPhysicsAngularVelocityInDegrees(FVector(Record.AngularVelocity));
+		}
+	}
+
+	TArray<uint8> BrokenBits;
+	BrokenBits.SetNumUninitialized((NumTargets + 7) / 8);
+	Reader.Serialize(BrokenBits.GetData(), BrokenBits.Num());
+	for (int32 i = 0; i < NumTargets; ++i)
+	{
+		ABreakableTarget* Target = m_Targets[i].Get();
+		const bool bWasBroken = (BrokenBits[i / 8] >> (i % 8)) & 1;
+		// Targets broken at capture time are left as they are, there is no cheap way to break them again
+		if (Target && (Target->m_IsBroken || Target->IsGeometryCollectionActive()) && !bWasBroken)
+		{
+			Target->ResetTarget();
+		}
+	}
+
+	for (int32 i = 0; i < NumCharacters; ++i)
+	{
+		FCharacterRecord Record;
+		Reader << Record;
+		if (APhysicsCharacter* Character = m_Characters[i].Get())
+		{
+			Character->ResetState(Record.Body.Location, FQuat(Record.Body.Rotation).Rotator(), FVector(Record.Body.LinearVelocity), FRotator(Record.ControlRotation), Record.Health, Record.Stamina);
+		}
+	}
+
+	for (TActorIterator<APhysicsProjectile> It(World); It; ++It)
+	{
+		It->Destroy();
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	for (int32 i = 0; i < NumProjectiles; ++i)
+	{
+		FBodyRecord Record;
+		Reader << Record;
+		APhysicsProjectile* Projectile = World->SpawnActor<APhysicsProjectile>(m_ProjectileClasses[i], Record.Location, FQuat(Record.Rotation).Rotator(), SpawnParams);
+		if (Projectile)
+		{
+			Projectile->m_OwnerWeapon = m_ProjectileWeapons[i].Get();
+			Projectile->GetProjectileMovement()->Velocity = FVector(Record.LinearVelocity);
+		}
+	}
+
+	m_LastRestoreMs = static_cast<float>((FPlatformTime::Seconds() - StartTime) * 1000.0);
+	UE_LOG(LogPhysicsSnapshot, Log, TEXT("Snapshot restored in %.3f ms (%d bytes)"), m_LastRestoreMs, m_Data.Num());
+	return true;
+}
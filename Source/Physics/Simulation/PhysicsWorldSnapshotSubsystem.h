@@ -0,0 +1,60 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PhysicsWorldSnapshotSubsystem.generated.h"
+
+class ABreakableTarget;
+class APhysicsCharacter;
+class APhysicsProjectile;
+class UPhysicsWeaponComponent;
+class UPrimitiveComponent;
+
+/**
+ * Captures the gameplay relevant state of the world right after BeginPlay into one binary blob
+ * (simulated bodies, breakable targets, characters and live projectiles) and restores it in place,
+ * so a round can restart without reloading the map.
+ * The blob only holds values, the objects they belong to are kept in the parallel arrays below in blob order.
+ */
+UCLASS()
+class PHYSICS_API UPhysicsWorldSnapshotSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** USubsystem **/
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/** UWorldSubsystem **/
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Captures the current world state, replacing the previous snapshot */
+	UFUNCTION(BlueprintCallable, Category = Snapshot)
+	void Capture();
+
+	/** Puts the world back in the captured state, returns false if nothing was captured */
+	UFUNCTION(BlueprintCallable, Category = Snapshot)
+	bool Restore();
+
+	UFUNCTION(BlueprintCallable, Category = Snapshot)
+	bool HasSnapshot() const { return m_Data.Num() > 0; }
+
+	/** Size of the captured blob, in bytes */
+	UFUNCTION(BlueprintCallable, Category = Snapshot)
+	int32 GetSnapshotSize() const { return m_Data.Num(); }
+
+	/** Duration of the last restore, in milliseconds */
+	UFUNCTION(BlueprintCallable, Category = Snapshot)
+	float GetLastRestoreMs() const { return m_LastRestoreMs; }
+
+protected:
+	TArray<uint8> m_Data;
+
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> m_Bodies;
+	TArray<TWeakObjectPtr<ABreakableTarget>> m_Targets;
+	TArray<TWeakObjectPtr<APhysicsCharacter>> m_Characters;
+	TArray<TSubclassOf<APhysicsProjectile>> m_ProjectileClasses;
+	TArray<TWeakObjectPtr<UPhysicsWeaponComponent>> m_ProjectileWeapons;
+
+	float m_LastRestoreMs = 0.f;
+};
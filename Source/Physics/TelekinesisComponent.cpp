@@ -0,0 +1,455 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TelekinesisComponent.h"
+#include "PhysicsStats.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/OverlapResult.h"
+#include "Engine/World.h"
+#include "Chaos/ParticleHandle.h"
+#include "Chaos/PBDRigidsEvolutionGBF.h"
+#include "GeometryCollection/GeometryCollectionComponent.h"
+#include "PhysicsProxy/GeometryCollectionPhysicsProxy.h"
+#include "PhysicsProxy/SingleParticlePhysicsProxy.h"
+#include "PBDRigidsSolver.h"
+#include "Core/GameplayMathConversions.h"
+#include "Profiling/PhysicsHitchDetector.h"
+#include "Simulation/DebrisBakeSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Telekinesis Solve"), STAT_TelekinesisSolve, STATGROUP_PhysicsGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Telekinesis Held Bodies"), STAT_TelekinesisHeldBodies, STATGROUP_PhysicsGame);
+
+namespace
+{
+	/** Particle of a held body for this step, null once it can no longer be driven */
+	Chaos::FPBDRigidParticleHandle* ResolveParticle(Chaos::FSingleParticlePhysicsProxy* SingleProxy, FGeometryCollectionPhysicsProxy* CollectionProxy, int32 TransformIndex)
+	{
+		if (SingleProxy)
+		{
+			Chaos::FGeometryParticleHandle* Handle = SingleProxy->GetHandle_LowLevel();
+			return Handle ? Handle->CastToRigidParticle() : nullptr;
+		}
+		if (CollectionProxy)
+		{
+			// A held piece that has since been clustered into another one, or broken apart, is disabled
+			Chaos::FPBDRigidClusteredParticleHandle* Particle = CollectionProxy->GetParticle_Internal(TransformIndex);
+			return Particle && !Particle->Disabled() ? Particle : nullptr;
+		}
+		return nullptr;
+	}
+
+	Chaos::FPBDRigidsSolver* GetSolver(const Chaos::FSingleParticlePhysicsProxy* SingleProxy, const FGeometryCollectionPhysicsProxy* CollectionProxy)
+	{
+		return SingleProxy ? SingleProxy->GetSolver<Chaos::FPBDRigidsSolver>() : CollectionProxy->GetSolver<Chaos::FPBDRigidsSolver>();
+	}
+}
+
+UTelekinesisComponent::UTelekinesisComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+}
+
+void UTelekinesisComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Runs on the physics thread when async physics is enabled, otherwise once per physics step on the game thread
+	SetAsyncPhysicsTickEnabled(true);
+}
+
+bool UTelekinesisComponent::GetViewPoint(FVector& OutLocation, FRotator& OutRotation) const
+{
+	if (!GetOwner())
+	{
+		return false;
+	}
+	GetOwner()->GetActorEyesViewPoint(OutLocation, OutRotation);
+	return true;
+}
+
+int32 UTelekinesisComponent::Grab()
+{
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	if (m_HeldBodies.Num() > 0 || !GetViewPoint(ViewLocation, ViewRotation))
+	{
+		return m_HeldBodies.Num();
+	}
+
+	PHYSICS_HITCH_SCOPE(TelekinesisGrab, GetWorld());
+
+	const FVector ViewDirection = ViewRotation.Vector();
+	const FVector Centre = m_Shape == ETelekinesisShape::SPHERE ? ViewLocation + ViewDirection * m_HoldDistance : ViewLocation;
+	const float CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(m_ConeHalfAngle));
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(TelekinesisGrab), false, GetOwner());
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_PhysicsBody);
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+
+	TArray<FOverlapResult> Overlaps;
+	GetWorld()->OverlapMultiByObjectType(Overlaps, Centre, FQuat::Identity, ObjectParams, FCollisionShape::MakeSphere(m_GrabRange), Params);
+
+	// Baked debris is only drawn, bring it back to life and grab the real fragments
+	UDebrisBakeSubsystem* DebrisBake = GetWorld()->GetSubsystem<UDebrisBakeSubsystem>();
+	if (DebrisBake && DebrisBake->WakeFromOverlaps(Overlaps))
+	{
+		Overlaps.Reset();
+		GetWorld()->OverlapMultiByObjectType(Overlaps, Centre, FQuat::Identity, ObjectParams, FCollisionShape::MakeSphere(m_GrabRange), Params);
+	}
+
+	struct FCandidate
+	{
+		float DistanceSquared;
+		UPrimitiveComponent* Component;
+		int32 TransformIndex;
+	};
+	TArray<FCandidate> Candidates;
+	auto AddCandidate = [&](const FVector& Location, UPrimitiveComponent* Component, int32 TransformIndex)
+	{
+		const FVector ToBody = Location - ViewLocation;
+		if (m_Shape == ETelekinesisShape::CONE && FVector::DotProduct(ToBody.GetSafeNormal(), ViewDirection) < CosHalfAngle)
+		{
+			return;
+		}
+		Candidates.Add({ static_cast<float>(ToBody.SizeSquared()), Component, TransformIndex });
+	};
+
+	// A geometry collection overlaps once per fragment shape, its pieces are gathered on the first hit
+	TSet<const UPrimitiveComponent*> Visited;
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		UPrimitiveComponent* Component = Overlap.GetComponent();
+		if (!Component || Component->Mobility != EComponentMobility::Movable || !Component->IsSimulatingPhysics())
+		{
+			continue;
+		}
+		bool bAlreadyVisited = false;
+		Visited.Add(Component, &bAlreadyVisited);
+		if (bAlreadyVisited)
+		{
+			continue;
+		}
+
+		if (UGeometryCollectionComponent* GeometryCollection = Cast<UGeometryCollectionComponent>(Component))
+		{
+			const FGeometryDynamicCollection* DynamicCollection = GeometryCollection->GetDynamicCollection();
+			if (!DynamicCollection || !GeometryCollection->GetPhysicsProxy())
+			{
+				continue;
+			}
+
+			// Pieces simulated on their own right now only: broken off fragments and the clusters still holding together.
+			// Fragments inside an unbroken cluster would take a slot each and never move
+			const FTransform& ComponentTransform = GeometryCollection->GetComponentTransform();
+			const auto& Transforms = GeometryCollection->GetComponentSpaceTransforms();
+			for (int32 i = 0; i < Transforms.Num() && i < DynamicCollection->Active.Num(); ++i)
+			{
+				const FVector Location = ComponentTransform.TransformPosition(FVector(Transforms[i].GetTranslation()));
+				if (DynamicCollection->Active[i] && FVector::DistSquared(Location, Centre) <= FMath::Square(m_GrabRange))
+				{
+					AddCandidate(Location, Component, i);
+				}
+			}
+			continue;
+		}
+
+		const FBodyInstance* Body = Component->GetBodyInstance();
+		if (Body && Body->GetPhysicsActorHandle())
+		{
+			AddCandidate(Component->GetComponentLocation(), Component, INDEX_NONE);
+		}
+	}
+
+	Candidates.Sort([](const FCandidate& A, const FCandidate& B) { return A.DistanceSquared < B.DistanceSquared; });
+	Candidates.SetNum(FMath::Min(Candidates.Num(), m_MaxHeldBodies), EAllowShrinking::No);
+
+	TArray<FVector> SlotOffsets;
+	SlotOffsets.Reserve(Candidates.Num());
+	for (int32 i = 0; i < Candidates.Num(); ++i)
+	{
+		UPrimitiveComponent* Component = Candidates[i].Component;
+		if (Candidates[i].TransformIndex == INDEX_NONE)
+		{
+			// Fragment gravity and sleep are handled per particle on the physics thread, not for the whole collection
+			Component->SetEnableGravity(false);
+			Component->WakeAllRigidBodies();
+		}
+		if (!m_WatchedComponents.Contains(Component))
+		{
+			Component->OnComponentPhysicsStateChanged.AddUniqueDynamic(this, &UTelekinesisComponent::OnHeldPhysicsStateChanged);
+			m_WatchedComponents.Add(Component);
+		}
+		m_HeldBodies.Add({ Component, Candidates[i].TransformIndex });
+
+		// Fibonacci sphere, evenly spreads any number of slots around the formation centre
+		const float Z = 1.f - (i + 0.5f) * 2.f / Candidates.Num();
+		const float Radius = FMath::Sqrt(FMath::Max(0.f, 1.f - Z * Z));
+		const float Phi = i * PI * (3.f - FMath::Sqrt(5.f));
+		SlotOffsets.Add(FVector(Z, Radius * FMath::Cos(Phi), Radius * FMath::Sin(Phi)) * m_FormationRadius);
+	}
+
+	{
+		FScopeLock Lock(&m_Lock);
+		m_SlotOffsets = MoveTemp(SlotOffsets);
+	}
+	RebuildProxies();
+
+	return m_HeldBodies.Num();
+}
+
+void UTelekinesisComponent::Throw()
+{
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	ReleaseInternal(GetViewPoint(ViewLocation, ViewRotation) ? ViewRotation.Vector() * m_ThrowSpeed : FVector::ZeroVector);
+}
+
+void UTelekinesisComponent::Release()
+{
+	ReleaseInternal(FVector::ZeroVector);
+}
+
+void UTelekinesisComponent::ReleaseInternal(const FVector& ThrowVelocity)
+{
+	for (const FHeldBody& Held : m_HeldBodies)
+	{
+		if (Held.Component.IsValid() && Held.TransformIndex == INDEX_NONE)
+		{
+			Held.Component->SetEnableGravity(true);
+		}
+	}
+	m_HeldBodies.Reset();
+	m_NumValidHeld = 0;
+
+	// Applied by the next physics step in one pass, together with the last spring update. Fragments get their gravity back there too
+	FScopeLock Lock(&m_Lock);
+	for (const FHeldProxy& Proxy : m_Proxies)
+	{
+		m_ReleasedProxies.Emplace(Proxy, ThrowVelocity);
+	}
+	m_Proxies.Reset();
+	m_SlotOffsets.Reset();
+}
+
+void UTelekinesisComponent::ApplyRelease(const FHeldProxy& Proxy, const FVector& ThrowVelocity)
+{
+	Chaos::FPBDRigidParticleHandle* Particle = ResolveParticle(Proxy.SingleProxy, Proxy.CollectionProxy, Proxy.TransformIndex);
+	if (!Particle)
+	{
+		return;
+	}
+	if (Proxy.CollectionProxy)
+	{
+		Particle->SetGravityEnabled(true);
+	}
+	Particle->SetV(Particle->GetV() + ThrowVelocity);
+}
+
+void UTelekinesisComponent::RebuildProxies()
+{
+	TArray<FHeldProxy> Proxies;
+	Proxies.Reserve(m_HeldBodies.Num());
+	m_NumValidHeld = 0;
+	for (const FHeldBody& Held : m_HeldBodies)
+	{
+		FHeldProxy& Proxy = Proxies.AddDefaulted_GetRef();
+		UPrimitiveComponent* Component = Held.Component.Get();
+		if (!Component)
+		{
+			continue;
+		}
+
+		++m_NumValidHeld;
+		Proxy.Owner = Component;
+		Proxy.TransformIndex = Held.TransformIndex;
+		if (Held.TransformIndex != INDEX_NONE)
+		{
+			Proxy.CollectionProxy = CastChecked<UGeometryCollectionComponent>(Component)->GetPhysicsProxy();
+		}
+		else if (const FBodyInstance* Body = Component->GetBodyInstance())
+		{
+			Proxy.SingleProxy = Body->GetPhysicsActorHandle();
+		}
+	}
+
+	FScopeLock Lock(&m_Lock);
+	m_Proxies = MoveTemp(Proxies);
+}
+
+void UTelekinesisComponent::OnHeldPhysicsStateChanged(UPrimitiveComponent* ChangedComponent, EComponentPhysicsStateChange StateChange)
+{
+	if (StateChange != EComponentPhysicsStateChange::Destroyed)
+	{
+		return;
+	}
+
+	// The solver frees the proxy after a later step, the physics thread must not see it past this point
+	FScopeLock Lock(&m_Lock);
+	for (FHeldProxy& Proxy : m_Proxies)
+	{
+		if (Proxy.Owner == ChangedComponent)
+		{
+			Proxy = FHeldProxy();
+		}
+	}
+	m_ReleasedProxies.RemoveAll([ChangedComponent](const TPair<FHeldProxy, FVector>& Released) { return Released.Key.Owner == ChangedComponent; });
+}
+
+void UTelekinesisComponent::UnwatchReleasedComponents()
+{
+	{
+		FScopeLock Lock(&m_Lock);
+		if (!m_ReleasedProxies.IsEmpty())
+		{
+			return;
+		}
+	}
+
+	for (const TWeakObjectPtr<UPrimitiveComponent>& Component : m_WatchedComponents)
+	{
+		if (Component.IsValid())
+		{
+			Component->OnComponentPhysicsStateChanged.RemoveDynamic(this, &UTelekinesisComponent::OnHeldPhysicsStateChanged);
+		}
+	}
+	m_WatchedComponents.Reset();
+}
+
+void UTelekinesisComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SET_DWORD_STAT(STAT_TelekinesisHeldBodies, m_HeldBodies.Num());
+	if (m_HeldBodies.IsEmpty())
+	{
+		if (!m_WatchedComponents.IsEmpty())
+		{
+			UnwatchReleasedComponents();
+		}
+		return;
+	}
+
+	// Components destroyed while held leave a null slot so the formation does not reshuffle
+	int32 NumValid = 0;
+	for (const FHeldBody& Held : m_HeldBodies)
+	{
+		NumValid += Held.Component.IsValid() ? 1 : 0;
+	}
+	if (NumValid != m_NumValidHeld)
+	{
+		RebuildProxies();
+	}
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	if (GetViewPoint(ViewLocation, ViewRotation))
+	{
+		FScopeLock Lock(&m_Lock);
+		m_AnchorLocation = ViewLocation + ViewRotation.Vector() * m_HoldDistance;
+		m_AnchorRotation = ViewRotation.Quaternion();
+	}
+}
+
+void UTelekinesisComponent::AsyncPhysicsTickComponent(float DeltaTime, float SimTime)
+{
+	Super::AsyncPhysicsTickComponent(DeltaTime, SimTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_TelekinesisSolve);
+
+	FScopeLock Lock(&m_Lock);
+
+	// Bodies still driven this step, split per axis so the spring runs as one batch per axis
+	m_SolveParticles.Reset();
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		m_SolvePosition[Axis].Reset();
+		m_SolveVelocity[Axis].Reset();
+		m_SolveTarget[Axis].Reset();
+	}
+	for (int32 i = 0; i < m_Proxies.Num(); ++i)
+	{
+		const FHeldProxy& Proxy = m_Proxies[i];
+		Chaos::FPBDRigidParticleHandle* Particle = ResolveParticle(Proxy.SingleProxy, Proxy.CollectionProxy, Proxy.TransformIndex);
+		if (!Particle || Particle->ObjectState() == Chaos::EObjectStateType::Kinematic)
+		{
+			continue;
+		}
+
+		if (Particle->ObjectState() == Chaos::EObjectStateType::Sleeping)
+		{
+			GetSolver(Proxy.SingleProxy, Proxy.CollectionProxy)->GetEvolution()->SetParticleObjectState(Particle, Chaos::EObjectStateType::Dynamic);
+		}
+		if (Proxy.CollectionProxy)
+		{
+			Particle->SetGravityEnabled(false);
+		}
+
+		// Positions are taken relative to the anchor so the float batch keeps full precision far from the origin
+		const FVector Position = Particle->GetX() - m_AnchorLocation;
+		const FVector Velocity = Particle->GetV();
+		const FVector Target = m_AnchorRotation.RotateVector(m_SlotOffsets[i]);
+		m_SolveParticles.Add(Particle);
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			m_SolvePosition[Axis].Add(static_cast<float>(Position[Axis]));
+			m_SolveVelocity[Axis].Add(static_cast<float>(Velocity[Axis]));
+			m_SolveTarget[Axis].Add(static_cast<float>(Target[Axis]));
+		}
+	}
+
+	// Spring/damper integrated as a velocity change, so every body follows its slot the same way whatever its mass
+	const float Stiffness = m_Stiffness * DeltaTime;
+	const float Damping = FMath::Clamp(m_Damping * DeltaTime, 0.f, 1.f);
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		PhysicsCore::SpringDamperBatch(m_SolveVelocity[Axis].GetData(), m_SolvePosition[Axis].GetData(), m_SolveTarget[Axis].GetData(), m_SolveParticles.Num(), Stiffness, Damping);
+	}
+	for (int32 i = 0; i < m_SolveParticles.Num(); ++i)
+	{
+		Chaos::FPBDRigidParticleHandle* Particle = m_SolveParticles[i];
+		Particle->SetV(FVector(m_SolveVelocity[0][i], m_SolveVelocity[1][i], m_SolveVelocity[2][i]));
+		Particle->SetW(Particle->GetW() * (1.f - Damping));
+	}
+
+	for (const TPair<FHeldProxy, FVector>& Released : m_ReleasedProxies)
+	{
+		ApplyRelease(Released.Key, Released.Value);
+	}
+	m_ReleasedProxies.Reset();
+}
+
+void UTelekinesisComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Release();
+
+	// Nothing steps this component any more, the release batch goes to the solvers as commands instead.
+	// They run at the start of the next step, ahead of the removal of any proxy unregistered after this point
+	TMap<Chaos::FPBDRigidsSolver*, TArray<TPair<FHeldProxy, FVector>>> ReleasedPerSolver;
+	{
+		FScopeLock Lock(&m_Lock);
+		for (const TPair<FHeldProxy, FVector>& Released : m_ReleasedProxies)
+		{
+			if (Released.Key.SingleProxy || Released.Key.CollectionProxy)
+			{
+				ReleasedPerSolver.FindOrAdd(GetSolver(Released.Key.SingleProxy, Released.Key.CollectionProxy)).Add(Released);
+			}
+		}
+		m_ReleasedProxies.Reset();
+	}
+	for (TPair<Chaos::FPBDRigidsSolver*, TArray<TPair<FHeldProxy, FVector>>>& SolverReleased : ReleasedPerSolver)
+	{
+		if (SolverReleased.Key)
+		{
+			SolverReleased.Key->EnqueueCommandImmediate([Released = MoveTemp(SolverReleased.Value)]()
+			{
+				for (const TPair<FHeldProxy, FVector>& Entry : Released)
+				{
+					ApplyRelease(Entry.Key, Entry.Value);
+				}
+			});
+		}
+	}
+	UnwatchReleasedComponents();
+
+	Super::EndPlay(EndPlayReason);
+}
@@ -0,0 +1,153 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "Chaos/ParticleHandleFwd.h"
+#include "TelekinesisComponent.generated.h"
+
+class FGeometryCollectionPhysicsProxy;
+
+namespace Chaos
+{
+	class FSingleParticlePhysicsProxy;
+}
+
+UENUM(BlueprintType)
+enum class ETelekinesisShape : uint8
+{
+	SPHERE,
+	CONE
+};
+
+/**
+ * Holds many simulated bodies at once in front of the owner's view point.
+ * Single body components and the pieces of geometry collections simulated on their own are grabbed, each piece as its own body.
+ * All held bodies are pulled toward their formation slot by one spring/damper pass per physics step
+ * in AsyncPhysicsTickComponent, instead of one UPhysicsHandleComponent per body.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class PHYSICS_API UTelekinesisComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	/** Area searched for bodies when grabbing */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Telekinesis)
+	ETelekinesisShape m_Shape = ETelekinesisShape::CONE;
+
+	/** Sphere radius, or cone length */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Telekinesis)
+	float m_GrabRange = 1500.f;
+
+	/** Cone half angle, in degrees */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Telekinesis)
+	float m_ConeHalfAngle = 20.f;
+
+	/** Bodies held at most, nearest ones win */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Telekinesis, meta = (ClampMin = "1"))
+	int32 m_MaxHeldBodies = 64;
+
+	/** Distance from the view point to the formation centre */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Telekinesis)
+	float m_HoldDistance = 400.f;
+
+	/** Radius of the formation the bodies are spread on */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Telekinesis)
+	float m_FormationRadius = 120.f;
+
+	/** Spring stiffness, acceleration per cm of error (1/s^2) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Telekinesis)
+	float m_Stiffness = 80.f;
+
+	/** Spring damping, acceleration per cm/s of velocity (1/s) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Telekinesis)
+	float m_Damping = 14.f;
+
+	/** Speed added along the view direction when throwing */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Telekinesis)
+	float m_ThrowSpeed = 2500.f;
+
+	UTelekinesisComponent();
+
+	/** Grabs every simulated body and debris fragment in the configured shape in front of the owner's view point */
+	UFUNCTION(BlueprintCallable, Category = Telekinesis)
+	int32 Grab();
+
+	/** Releases every held body with one velocity change along the view direction */
+	UFUNCTION(BlueprintCallable, Category = Telekinesis)
+	void Throw();
+
+	/** Releases every held body without throwing it */
+	UFUNCTION(BlueprintCallable, Category = Telekinesis)
+	void Release();
+
+	UFUNCTION(BlueprintCallable, Category = Telekinesis)
+	int32 GetNumHeldBodies() const { return m_HeldBodies.Num(); }
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void AsyncPhysicsTickComponent(float DeltaTime, float SimTime) override;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Drops the physics thread references to a held component before its proxy is handed back to the solver */
+	UFUNCTION()
+	void OnHeldPhysicsStateChanged(UPrimitiveComponent* ChangedComponent, EComponentPhysicsStateChange StateChange);
+
+	bool GetViewPoint(FVector& OutLocation, FRotator& OutRotation) const;
+
+	/** Rebuilds the proxy list read by the physics thread from the held bodies */
+	void RebuildProxies();
+
+	/** Releases every held body, restoring gravity, and hands their proxies to the next physics step with the throw velocity */
+	void ReleaseInternal(const FVector& ThrowVelocity);
+
+	/** Stops listening to components that are neither held nor waiting for their release on the physics thread */
+	void UnwatchReleasedComponents();
+
+	struct FHeldBody
+	{
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		/** Fragment transform index when the component is a geometry collection */
+		int32 TransformIndex = INDEX_NONE;
+	};
+
+	/** Physics thread view of a held body, resolved to its particle on every step */
+	struct FHeldProxy
+	{
+		Chaos::FSingleParticlePhysicsProxy* SingleProxy = nullptr;
+		FGeometryCollectionPhysicsProxy* CollectionProxy = nullptr;
+		int32 TransformIndex = INDEX_NONE;
+		/** Only compared on the game thread, to find the entries of a component losing its physics state */
+		const UPrimitiveComponent* Owner = nullptr;
+	};
+
+	/** Physics thread only, gives a released body its gravity back and adds the throw velocity */
+	static void ApplyRelease(const FHeldProxy& Proxy, const FVector& ThrowVelocity);
+
+	/** Held bodies, owned by the game thread */
+	TArray<FHeldBody> m_HeldBodies;
+	int32 m_NumValidHeld = 0;
+
+	/** Components whose physics state changes are listened to while they are held or being released */
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> m_WatchedComponents;
+
+	/** Everything below is shared with the physics thread and guarded by m_Lock */
+	FCriticalSection m_Lock;
+	TArray<FHeldProxy> m_Proxies;
+	TArray<FVector> m_SlotOffsets;
+	FVector m_AnchorLocation = FVector::ZeroVector;
+	FQuat m_AnchorRotation = FQuat::Identity;
+	/** Released bodies with the velocity change they get on the next step, zero for a plain release */
+	TArray<TPair<FHeldProxy, FVector>> m_ReleasedProxies;
+
+	/** Physics thread scratch, the bodies driven this step and their state split per axis for the batch spring */
+	TArray<Chaos::FPBDRigidParticleHandle*> m_SolveParticles;
+	TArray<float> m_SolvePosition[3];
+	TArray<float> m_SolveVelocity[3];
+	TArray<float> m_SolveTarget[3];
+};
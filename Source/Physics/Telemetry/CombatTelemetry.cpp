@@ -0,0 +1,349 @@
+#include "Telemetry/CombatTelemetry.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Compression.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCombatTelemetry, Log, All);
+
+namespace
+{
+	constexpr uint32 RingCapacity = 8192;
+	constexpr uint32 RingMask = RingCapacity - 1;
+	static_assert((RingCapacity & RingMask) == 0, "Ring capacity must be a power of two");
+
+	/** Records pending on the writer thread before a chunk is compressed and written */
+	constexpr int32 ChunkRecords = 16384;
+	constexpr uint32 FlushIntervalMs = 250;
+
+	/** Single producer (the owning thread), single consumer (the writer thread) */
+	struct FTelemetryRing
+	{
+		FCombatTelemetryRecord Records[RingCapacity];
+		std::atomic<uint32> Head{ 0 };
+		std::atomic<uint32> Tail{ 0 };
+	};
+
+	// Rings are never freed: the thread local pointers of finished threads would dangle and a ring is only 320KB
+	FCriticalSection GRingsLock;
+	TArray<FTelemetryRing*> GRings;
+	thread_local FTelemetryRing* GThreadRing = nullptr;
+
+	FTelemetryRing& GetThreadRing()
+	{
+		if (!GThreadRing)
+		{
+			GThreadRing = new FTelemetryRing();
+			FScopeLock Lock(&GRingsLock);
+			GRings.Add(GThreadRing);
+		}
+		return *GThreadRing;
+	}
+
+	class FCombatTelemetryWriter : public FRunnable
+	{
+	public:
+		FCombatTelemetryWriter(TUniquePtr<FArchive>&& File, uint64 StartCycles)
+			: m_File(MoveTemp(File))
+			, m_StartCycles(StartCycles)
+		{
+			m_WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+			m_Pending.Reserve(ChunkRecords * 2);
+		}
+
+		virtual ~FCombatTelemetryWriter() override
+		{
+			FPlatformProcess::ReturnSynchEventToPool(m_WakeEvent);
+		}
+
+		virtual uint32 Run() override
+		{
+			while (!m_bStopRequested.load())
+			{
+				m_WakeEvent->Wait(FlushIntervalMs);
+				Drain();
+				if (m_Pending.Num() >= ChunkRecords)
+				{
+					WriteChunk();
+				}
+			}
+
+			Drain();
+			WriteChunk();
+			m_File->Close();
+			return 0;
+		}
+
+		virtual void Stop() override
+		{
+			m_bStopRequested = true;
+			m_WakeEvent->Trigger();
+		}
+
+		int64 GetWrittenRecords() const { return m_WrittenRecords; }
+		int64 GetWrittenBytes() const { return m_WrittenBytes; }
+
+	private:
+		void Drain()
+		{
+			TArray<FTelemetryRing*, TInlineAllocator<16>> Rings;
+			{
+				FScopeLock Lock(&GRingsLock);
+				Rings = GRings;
+			}
+
+			for (FTelemetryRing* Ring : Rings)
+			{
+				const uint32 Head = Ring->Head.load(std::memory_order_acquire);
+				uint32 Tail = Ring->Tail.load(std::memory_order_relaxed);
+				for (; Tail != Head; ++Tail)
+				{
+					// Records written after the previous session stopped but before it was drained are skipped
+					const FCombatTelemetryRecord& Record = Ring->Records[Tail & RingMask];
+					if (Record.Cycles >= m_StartCycles)
+					{
+						m_Pending.Add(Record);
+					}
+				}
+				Ring->Tail.store(Tail, std::memory_order_release);
+			}
+		}
+
+		void WriteChunk()
+		{
+			if (m_Pending.IsEmpty())
+			{
+				return;
+			}
+
+			// Rings are drained one after the other, sorting merges the threads back and keeps the cycle deltas small
+			m_Pending.Sort([](const FCombatTelemetryRecord& A, const FCombatTelemetryRecord& B) { return A.Cycles < B.Cycles; });
+			FCombatTelemetry::WriteColumns(m_Pending, m_Columns);
+
+			int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, m_Columns.Num());
+			m_Compressed.SetNumUninitialized(CompressedSize, EAllowShrinking::No);
+			if (!FCompression::CompressMemory(NAME_Zlib, m_Compressed.GetData(), CompressedSize, m_Columns.GetData(), m_Columns.Num()))
+			{
+				UE_LOG(LogCombatTelemetry, Warning, TEXT("Failed to compress %d records, chunk dropped"), m_Pending.Num());
+				m_Pending.Reset();
+				return;
+			}
+
+			FCombatTelemetry::FChunkHeader Header;
+			Header.NumRecords = m_Pending.Num();
+			Header.RawSize = m_Columns.Num();
+			Header.CompressedSize = CompressedSize;
+			m_File->Serialize(&Header, sizeof(Header));
+			m_File->Serialize(m_Compressed.GetData(), CompressedSize);
+			m_File->Flush();
+
+			m_WrittenRecords += m_Pending.Num();
+			m_WrittenBytes += sizeof(Header) + CompressedSize;
+			m_Pending.Reset();
+		}
+
+		TUniquePtr<FArchive> m_File;
+		FEvent* m_WakeEvent = nullptr;
+		std::atomic<bool> m_bStopRequested{ false };
+		uint64 m_StartCycles = 0;
+
+		TArray<FCombatTelemetryRecord> m_Pending;
+		TArray<uint8> m_Columns;
+		TArray<uint8> m_Compressed;
+		int64 m_WrittenRecords = 0;
+		int64 m_WrittenBytes = 0;
+	};
+
+	FCriticalSection GSessionLock;
+	FCombatTelemetryWriter* GWriter = nullptr;
+	FRunnableThread* GWriterThread = nullptr;
+	FString GSessionPath;
+}
+
+void FCombatTelemetry::Start(const FString& FilePath)
+{
+	FScopeLock Lock(&GSessionLock);
+	if (GWriter)
+	{
+		return;
+	}
+
+	TUniquePtr<FArchive> File(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!File)
+	{
+		UE_LOG(LogCombatTelemetry, Error, TEXT("Could not open %s"), *FilePath);
+		return;
+	}
+
+	FFileHeader Header;
+	Header.Magic = FileMagic;
+	Header.Version = FileVersion;
+	Header.SecondsPerCycle = FPlatformTime::GetSecondsPerCycle64();
+	File->Serialize(&Header, sizeof(Header));
+
+	DroppedRecords = 0;
+	RecordedEvents = 0;
+	RecordCycles = 0;
+	GSessionPath = FilePath;
+	GWriter = new FCombatTelemetryWriter(MoveTemp(File), FPlatformTime::Cycles64());
+	GWriterThread = FRunnableThread::Create(GWriter, TEXT("CombatTelemetryWriter"), 0, TPri_BelowNormal);
+	bRunning = true;
+
+	UE_LOG(LogCombatTelemetry, Display, TEXT("Combat telemetry writing to %s"), *FilePath);
+}
+
+void FCombatTelemetry::Stop()
+{
+	FScopeLock Lock(&GSessionLock);
+	if (!GWriter)
+	{
+		return;
+	}
+
+	bRunning = false;
+
+	// Kill(true) calls Stop on the runnable and waits for its final flush
+	GWriterThread->Kill(true);
+	delete GWriterThread;
+	GWriterThread = nullptr;
+
+	UE_LOG(LogCombatTelemetry, Display, TEXT("Combat telemetry closed %s: %lld records, %lld bytes, %llu dropped, %.1f ns per record"),
+		*GSessionPath, GWriter->GetWrittenRecords(), GWriter->GetWrittenBytes(), GetDroppedRecords(), GetAverageRecordNs());
+
+	delete GWriter;
+	GWriter = nullptr;
+}
+
+void FCombatTelemetry::RecordInternal(ECombatEvent Type, uint32 SubjectId, uint32 OtherId, float Value, const FVector& Location)
+{
+	FTelemetryRing& Ring = GetThreadRing();
+	const uint32 Head = Ring.Head.load(std::memory_order_relaxed);
+	if (Head - Ring.Tail.load(std::memory_order_acquire) >= RingCapacity)
+	{
+		DroppedRecords.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	FCombatTelemetryRecord& Record = Ring.Records[Head & RingMask];
+	Record.Cycles = StartCycles;
+	Record.SubjectId = SubjectId;
+	Record.OtherId = OtherId;
+	Record.Value = Value;
+	Record.X = static_cast<float>(Location.X);
+	Record.Y = static_cast<float>(Location.Y);
+	Record.Z = static_cast<float>(Location.Z);
+	Record.Type = Type;
+	Ring.Head.store(Head + 1, std::memory_order_release);
+
+	// The timestamp read doubles as the start of the cost measurement, only one more cycle read per event
+	RecordCycles.fetch_add(FPlatformTime::Cycles64() - StartCycles, std::memory_order_relaxed);
+	RecordedEvents.fetch_add(1, std::memory_order_relaxed);
+}
+
+double FCombatTelemetry::GetAverageRecordNs()
+{
+	const uint64 Events = RecordedEvents.load(std::memory_order_relaxed);
+	return Events ? FPlatformTime::ToSeconds64(RecordCycles.load(std::memory_order_relaxed)) * 1.e9 / Events : 0.0;
+}
+
+namespace
+{
+	constexpr int32 ColumnBytesPerRecord = sizeof(uint8) + sizeof(uint64) + 2 * sizeof(uint32) + 4 * sizeof(float);
+
+	template<typename T>
+	void WriteColumn(uint8*& Out, const TArray<FCombatTelemetryRecord>& Records, T (*Get)(const FCombatTelemetryRecord&))
+	{
+		for (const FCombatTelemetryRecord& Record : Records)
+		{
+			const T Value = Get(Record);
+			FMemory::Memcpy(Out, &Value, sizeof(T));
+			Out += sizeof(T);
+		}
+	}
+
+	template<typename T>
+	void ReadColumn(const uint8*& In, TArray<FCombatTelemetryRecord>& Records, void (*Set)(FCombatTelemetryRecord&, T))
+	{
+		for (FCombatTelemetryRecord& Record : Records)
+		{
+			T Value;
+			FMemory::Memcpy(&Value, In, sizeof(T));
+			In += sizeof(T);
+			Set(Record, Value);
+		}
+	}
+}
+
+void FCombatTelemetry::WriteColumns(const TArray<FCombatTelemetryRecord>& Records, TArray<uint8>& OutColumns)
+{
+	OutColumns.SetNumUninitialized(Records.Num() * ColumnBytesPerRecord, EAllowShrinking::No);
+	uint8* Out = OutColumns.GetData();
+
+	WriteColumn<uint8>(Out, Records, [](const FCombatTelemetryRecord& R) { return static_cast<uint8>(R.Type); });
+
+	// Cycles are stored as deltas to the previous record, the first one relative to zero
+	uint64 PreviousCycles = 0;
+	for (const FCombatTelemetryRecord& Record : Records)
+	{
+		const uint64 Delta = Record.Cycles - PreviousCycles;
+		FMemory::Memcpy(Out, &Delta, sizeof(Delta));
+		Out += sizeof(Delta);
+		PreviousCycles = Record.Cycles;
+	}
+
+	WriteColumn<uint32>(Out, Records, [](const FCombatTelemetryRecord& R) { return R.SubjectId; });
+	WriteColumn<uint32>(Out, Records, [](const FCombatTelemetryRecord& R) { return R.OtherId; });
+	WriteColumn<float>(Out, Records, [](const FCombatTelemetryRecord& R) { return R.Value; });
+	WriteColumn<float>(Out, Records, [](const FCombatTelemetryRecord& R) { return R.X; });
+	WriteColumn<float>(Out, Records, [](const FCombatTelemetryRecord& R) { return R.Y; });
+	WriteColumn<float>(Out, Records, [](const FCombatTelemetryRecord& R) { return R.Z; });
+}
+
+void FCombatTelemetry::ReadColumns(const TArray<uint8>& Columns, int32 NumRecords, TArray<FCombatTelemetryRecord>& OutRecords)
+{
+	OutRecords.SetNumZeroed(Columns.Num() >= NumRecords * ColumnBytesPerRecord ? NumRecords : 0);
+	const uint8* In = Columns.GetData();
+
+	ReadColumn<uint8>(In, OutRecords, [](FCombatTelemetryRecord& R, uint8 V) { R.Type = static_cast<ECombatEvent>(V); });
+
+	uint64 Cycles = 0;
+	ReadColumn<uint64>(In, OutRecords, [](FCombatTelemetryRecord& R, uint64 V) { R.Cycles = V; });
+	for (FCombatTelemetryRecord& Record : OutRecords)
+	{
+		Cycles += Record.Cycles;
+		Record.Cycles = Cycles;
+	}
+
+	ReadColumn<uint32>(In, OutRecords, [](FCombatTelemetryRecord& R, uint32 V) { R.SubjectId = V; });
+	ReadColumn<uint32>(In, OutRecords, [](FCombatTelemetryRecord& R, uint32 V) { R.OtherId = V; });
+	ReadColumn<float>(In, OutRecords, [](FCombatTelemetryRecord& R, float V) { R.Value = V; });
+	ReadColumn<float>(In, OutRecords, [](FCombatTelemetryRecord& R, float V) { R.X = V; });
+	ReadColumn<float>(In, OutRecords, [](FCombatTelemetryRecord& R, float V) { R.Y = V; });
+	ReadColumn<float>(In, OutRecords, [](FCombatTelemetryRecord& R, float V) { R.Z = V; });
+}
+
+void UCombatTelemetrySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (!m_bEnabled && !FParse::Param(FCommandLine::Get(), TEXT("CombatTelemetry")))
+	{
+		return;
+	}
+
+	const FString FilePath = FPaths::ProjectSavedDir() / TEXT("Telemetry") / FString::Printf(TEXT("Combat_%s.ctel"), *FDateTime::Now().ToString());
+	FCombatTelemetry::Start(FilePath);
+}
+
+void UCombatTelemetrySubsystem::Deinitialize()
+{
+	FCombatTelemetry::Stop();
+
+	Super::Deinitialize();
+}
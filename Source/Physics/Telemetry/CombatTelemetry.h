@@ -0,0 +1,118 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include <atomic>
+#include "CombatTelemetry.generated.h"
+
+UENUM(BlueprintType)
+enum class ECombatEvent : uint8
+{
+	SHOT,
+	HIT,
+	DAMAGE,
+	BREAK,
+	GRAB,
+	DEATH
+};
+
+/** One telemetry event, fixed size so it can be copied into the ring buffers without any formatting */
+struct FCombatTelemetryRecord
+{
+	/** FPlatformTime::Cycles64 when the event happened */
+	uint64 Cycles;
+	/** GetUniqueID of the object the event is about, 0 if none */
+	uint32 SubjectId;
+	/** GetUniqueID of the other object involved (instigator, target, grabbed actor), 0 if none */
+	uint32 OtherId;
+	/** Damage amount, remaining health... depending on the event */
+	float Value;
+	float X;
+	float Y;
+	float Z;
+	ECombatEvent Type;
+	uint8 Padding[7];
+};
+static_assert(sizeof(FCombatTelemetryRecord) == 40, "Telemetry records are written as fixed size columns");
+
+/**
+ * Combat telemetry writer.
+ * Record() copies the event into a lock free ring owned by the calling thread and never blocks: when the ring is full
+ * the record is dropped and counted. A background thread drains the rings and appends zlib compressed columnar chunks
+ * to Saved/Telemetry/*.ctel, which UCombatTelemetryToCsvCommandlet converts to CSV.
+ *
+ * File layout: FileHeader, then chunks of { ChunkHeader, compressed columns }.
+ * Columns are stored one after the other: Type (uint8), Cycles (uint64), SubjectId, OtherId (uint32), Value, X, Y, Z (float).
+ */
+class PHYSICS_API FCombatTelemetry
+{
+public:
+	static constexpr uint32 FileMagic = 0x4C455443; // 'CTEL'
+	static constexpr uint32 FileVersion = 1;
+
+	struct FFileHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		double SecondsPerCycle;
+	};
+
+	struct FChunkHeader
+	{
+		uint32 NumRecords;
+		uint32 RawSize;
+		uint32 CompressedSize;
+	};
+
+	/** Starts a new session file, does nothing if one is already open */
+	static void Start(const FString& FilePath);
+
+	/** Flushes what is left in the rings and closes the session file */
+	static void Stop();
+
+	static bool IsRunning() { return bRunning.load(std::memory_order_relaxed); }
+
+	/** Records one event from any thread */
+	static void Record(ECombatEvent Type, const UObject* Subject, const UObject* Other, float Value, const FVector& Location)
+	{
+		if (IsRunning())
+		{
+			RecordInternal(Type, Subject ? Subject->GetUniqueID() : 0, Other ? Other->GetUniqueID() : 0, Value, Location);
+		}
+	}
+
+	/** Records dropped because a ring was full since the session started */
+	static uint64 GetDroppedRecords() { return DroppedRecords.load(std::memory_order_relaxed); }
+
+	/** Records written since the session started and their average cost inside Record, in nanoseconds */
+	static uint64 GetWrittenEvents() { return RecordedEvents.load(std::memory_order_relaxed); }
+	static double GetAverageRecordNs();
+
+	/** Serializes records into the column layout of one chunk */
+	static void WriteColumns(const TArray<FCombatTelemetryRecord>& Records, TArray<uint8>& OutColumns);
+
+	/** Reads back the columns of one chunk */
+	static void ReadColumns(const TArray<uint8>& Columns, int32 NumRecords, TArray<FCombatTelemetryRecord>& OutRecords);
+
+private:
+	static void RecordInternal(ECombatEvent Type, uint32 SubjectId, uint32 OtherId, float Value, const FVector& Location);
+
+	static inline std::atomic<bool> bRunning{ false };
+	static inline std::atomic<uint64> DroppedRecords{ 0 };
+	static inline std::atomic<uint64> RecordedEvents{ 0 };
+	static inline std::atomic<uint64> RecordCycles{ 0 };
+};
+
+/** Runs the combat telemetry writer for the lifetime of the game instance when enabled in config or with -CombatTelemetry */
+UCLASS(config=Game)
+class PHYSICS_API UCombatTelemetrySubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(config)
+	bool m_bEnabled = false;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+};
@@ -0,0 +1,101 @@
+#include "Telemetry/CombatTelemetryToCsvCommandlet.h"
+#include "Telemetry/CombatTelemetry.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCombatTelemetryToCsv, Log, All);
+
+UCombatTelemetryToCsvCommandlet::UCombatTelemetryToCsvCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UCombatTelemetryToCsvCommandlet::Main(const FString& Params)
+{
+	FString InPath;
+	if (!FParse::Value(*Params, TEXT("In="), InPath))
+	{
+		UE_LOG(LogCombatTelemetryToCsv, Error, TEXT("Missing -In=<file.ctel>"));
+		return 1;
+	}
+
+	FString OutPath = FPaths::ChangeExtension(InPath, TEXT("csv"));
+	FParse::Value(*Params, TEXT("Out="), OutPath);
+
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *InPath))
+	{
+		UE_LOG(LogCombatTelemetryToCsv, Error, TEXT("Could not read %s"), *InPath);
+		return 1;
+	}
+
+	FCombatTelemetry::FFileHeader Header;
+	if (Data.Num() < sizeof(Header))
+	{
+		UE_LOG(LogCombatTelemetryToCsv, Error, TEXT("%s is too small to be a telemetry file"), *InPath);
+		return 1;
+	}
+	FMemory::Memcpy(&Header, Data.GetData(), sizeof(Header));
+	if (Header.Magic != FCombatTelemetry::FileMagic || Header.Version != FCombatTelemetry::FileVersion)
+	{
+		UE_LOG(LogCombatTelemetryToCsv, Error, TEXT("%s is not a version %u telemetry file"), *InPath, FCombatTelemetry::FileVersion);
+		return 1;
+	}
+
+	const UEnum* EventEnum = StaticEnum<ECombatEvent>();
+
+	FString Csv = TEXT("time_s,event,subject,other,value,x,y,z\n");
+	TArray<uint8> Columns;
+	TArray<FCombatTelemetryRecord> Records;
+	uint64 FirstCycles = 0;
+	int64 NumRecords = 0;
+
+	int64 Offset = sizeof(Header);
+	while (Offset + static_cast<int64>(sizeof(FCombatTelemetry::FChunkHeader)) <= Data.Num())
+	{
+		FCombatTelemetry::FChunkHeader Chunk;
+		FMemory::Memcpy(&Chunk, Data.GetData() + Offset, sizeof(Chunk));
+		Offset += sizeof(Chunk);
+
+		// A session that was not closed cleanly can end on a partial chunk
+		if (Offset + Chunk.CompressedSize > Data.Num())
+		{
+			UE_LOG(LogCombatTelemetryToCsv, Warning, TEXT("Truncated chunk at offset %lld, stopping"), Offset);
+			break;
+		}
+
+		Columns.SetNumUninitialized(Chunk.RawSize, EAllowShrinking::No);
+		if (!FCompression::UncompressMemory(NAME_Zlib, Columns.GetData(), Chunk.RawSize, Data.GetData() + Offset, Chunk.CompressedSize))
+		{
+			UE_LOG(LogCombatTelemetryToCsv, Warning, TEXT("Corrupted chunk at offset %lld, stopping"), Offset);
+			break;
+		}
+		Offset += Chunk.CompressedSize;
+
+		FCombatTelemetry::ReadColumns(Columns, Chunk.NumRecords, Records);
+		for (const FCombatTelemetryRecord& Record : Records)
+		{
+			if (NumRecords++ == 0)
+			{
+				FirstCycles = Record.Cycles;
+			}
+			Csv += FString::Printf(TEXT("%.6f,%s,%u,%u,%g,%.1f,%.1f,%.1f\n"),
+				static_cast<int64>(Record.Cycles - FirstCycles) * Header.SecondsPerCycle,
+				*EventEnum->GetNameStringByValue(static_cast<int64>(Record.Type)),
+				Record.SubjectId, Record.OtherId, Record.Value, Record.X, Record.Y, Record.Z);
+		}
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *OutPath))
+	{
+		UE_LOG(LogCombatTelemetryToCsv, Error, TEXT("Could not write %s"), *OutPath);
+		return 1;
+	}
+
+	UE_LOG(LogCombatTelemetryToCsv, Display, TEXT("Wrote %lld records to %s"), NumRecords, *OutPath);
+	return 0;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CombatTelemetryToCsvCommandlet.generated.h"
+
+/**
+ * Converts a combat telemetry session file to CSV.
+ * Usage: UnrealEditor-Cmd Physics.uproject -run=CombatTelemetryToCsv -In=<file.ctel> [-Out=<file.csv>]
+ */
+UCLASS()
+class PHYSICS_API UCombatTelemetryToCsvCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCombatTelemetryToCsvCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,184 @@
+#include "UI/TargetIndicatorSubsystem.h"
+#include "BreakableTarget.h"
+#include "PhysicsCosmetics.h"
+#include "PhysicsStats.h"
+#include "Core/GameplayMathConversions.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/GameViewportClient.h"
+#include "GameFramework/PlayerController.h"
+#include "SceneView.h"
+
+DECLARE_CYCLE_STAT(TEXT("Target Indicators"), STAT_TargetIndicators, STATGROUP_PhysicsGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Target Indicators Projected"), STAT_TargetIndicatorsProjected, STATGROUP_PhysicsGame);
+
+bool UTargetIndicatorSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	// Nothing to point at on a dedicated server
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && PhysicsCosmetics::IsEnabled(World) && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UTargetIndicatorSubsystem::AddTarget(ABreakableTarget* Target)
+{
+	if (!Target || m_TargetIndices.Contains(Target))
+	{
+		return;
+	}
+
+	const FVector Location = Target->GetActorLocation();
+	m_TargetIndices.Add(Target, m_Targets.Num());
+	m_Targets.Add(Target);
+	m_X.Add(static_cast<float>(Location.X));
+	m_Y.Add(static_cast<float>(Location.Y));
+	m_Z.Add(static_cast<float>(Location.Z));
+	m_OnScreen.Add(0);
+	m_Indicators.AddZeroed();
+	m_bRefreshAll = true;
+}
+
+void UTargetIndicatorSubsystem::RemoveTarget(ABreakableTarget* Target)
+{
+	const int32* Found = m_TargetIndices.Find(Target);
+	if (!Found)
+	{
+		return;
+	}
+
+	// Keep the on screen entries packed at the front, then swap with the last entry and pop
+	int32 Index = *Found;
+	if (Index < m_NumOnScreen)
+	{
+		--m_NumOnScreen;
+		SwapEntries(Index, m_NumOnScreen);
+		Index = m_NumOnScreen;
+	}
+	SwapEntries(Index, m_Targets.Num() - 1);
+
+	m_TargetIndices.Remove(Target);
+	m_Targets.Pop(EAllowShrinking::No);
+	m_X.Pop(EAllowShrinking::No);
+	m_Y.Pop(EAllowShrinking::No);
+	m_Z.Pop(EAllowShrinking::No);
+	m_OnScreen.Pop(EAllowShrinking::No);
+	m_Indicators.Pop(EAllowShrinking::No);
+}
+
+void UTargetIndicatorSubsystem::SwapEntries(int32 A, int32 B)
+{
+	if (A == B)
+	{
+		return;
+	}
+
+	m_TargetIndices[m_Targets[A]] = B;
+	m_TargetIndices[m_Targets[B]] = A;
+	m_Targets.Swap(A, B);
+	m_X.Swap(A, B);
+	m_Y.Swap(A, B);
+	m_Z.Swap(A, B);
+	m_OnScreen.Swap(A, B);
+	m_Indicators.Swap(A, B);
+}
+
+void UTargetIndicatorSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SCOPE_CYCLE_COUNTER(STAT_TargetIndicators);
+
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	const ULocalPlayer* LocalPlayer = PlayerController ? PlayerController->GetLocalPlayer() : nullptr;
+	if (!LocalPlayer || !LocalPlayer->ViewportClient || m_Targets.IsEmpty())
+	{
+		return;
+	}
+
+	FSceneViewProjectionData ProjectionData;
+	if (!LocalPlayer->GetProjectionData(LocalPlayer->ViewportClient->Viewport, ProjectionData))
+	{
+		return;
+	}
+
+	m_OffScreenTimer += DeltaTime;
+	const bool bRefreshOffScreen = m_bRefreshAll || m_OffScreenUpdateRate <= 0.f || m_OffScreenTimer * m_OffScreenUpdateRate >= 1.f;
+	if (bRefreshOffScreen)
+	{
+		m_OffScreenTimer = 0.f;
+		m_bRefreshAll = false;
+	}
+	const int32 Count = bRefreshOffScreen ? m_Targets.Num() : m_NumOnScreen;
+	SET_DWORD_STAT(STAT_TargetIndicatorsProjected, Count);
+	if (Count == 0)
+	{
+		return;
+	}
+
+	const FMatrix ViewProjection = ProjectionData.ComputeViewProjectionMatrix();
+	PhysicsCore::Matrix44 Matrix;
+	for (int32 Row = 0; Row < 4; ++Row)
+	{
+		for (int32 Col = 0; Col < 4; ++Col)
+		{
+			Matrix.M[Row][Col] = static_cast<float>(ViewProjection.M[Row][Col]);
+		}
+	}
+
+	const FIntRect ViewRect = ProjectionData.GetConstrainedViewRect();
+	const float Width = static_cast<float>(ViewRect.Width());
+	const float Height = static_cast<float>(ViewRect.Height());
+
+	m_ScreenX.SetNumUninitialized(Count, EAllowShrinking::No);
+	m_ScreenY.SetNumUninitialized(Count, EAllowShrinking::No);
+	m_W.SetNumUninitialized(Count, EAllowShrinking::No);
+	m_DirX.SetNumUninitialized(Count, EAllowShrinking::No);
+	m_DirY.SetNumUninitialized(Count, EAllowShrinking::No);
+	m_Distance.SetNumUninitialized(Count, EAllowShrinking::No);
+
+	PhysicsCore::ProjectPointsBatch(m_ScreenX.GetData(), m_ScreenY.GetData(), m_W.GetData(), m_X.GetData(), m_Y.GetData(), m_Z.GetData(), Count, Matrix, Width, Height);
+	PhysicsCore::ClampToScreenEdgeBatch(m_ScreenX.GetData(), m_ScreenY.GetData(), m_DirX.GetData(), m_DirY.GetData(), m_OnScreen.GetData(), m_W.GetData(), Count, Width, Height, m_EdgeMargin);
+	PhysicsCore::DistanceBatch(m_Distance.GetData(), m_X.GetData(), m_Y.GetData(), m_Z.GetData(), Count, PhysicsCore::ToCore(ProjectionData.ViewOrigin));
+
+	const FVector2f ViewMin(static_cast<float>(ViewRect.Min.X), static_cast<float>(ViewRect.Min.Y));
+	for (int32 i = 0; i < Count; ++i)
+	{
+		FTargetIndicator& Indicator = m_Indicators[i];
+		Indicator.ScreenPosition = FVector2f(m_ScreenX[i], m_ScreenY[i]) + ViewMin;
+		Indicator.EdgeDirection = FVector2f(m_DirX[i], m_DirY[i]);
+		Indicator.Distance = m_Distance[i];
+		Indicator.bOnScreen = m_OnScreen[i] != 0;
+	}
+
+	// Partition the updated range so the on screen targets stay in front, everything past Count is off screen already
+	int32 Front = 0;
+	int32 Back = Count - 1;
+	while (Front <= Back)
+	{
+		if (m_OnScreen[Front])
+		{
+			++Front;
+		}
+		else
+		{
+			SwapEntries(Front, Back--);
+		}
+	}
+	m_NumOnScreen = Front;
+}
+
+TStatId UTargetIndicatorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTargetIndicatorSubsystem, STATGROUP_Tickables);
+}
+
+void UTargetIndicatorSubsystem::GetIndicator(int32 Index, FVector2D& ScreenPosition, FVector2D& EdgeDirection, float& Distance, bool& bOnScreen) const
+{
+	if (!m_Indicators.IsValidIndex(Index))
+	{
+		return;
+	}
+
+	const FTargetIndicator& Indicator = m_Indicators[Index];
+	ScreenPosition = FVector2D(Indicator.ScreenPosition);
+	EdgeDirection = FVector2D(Indicator.EdgeDirection);
+	Distance = Indicator.Distance;
+	bOnScreen = Indicator.bOnScreen;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TargetIndicatorSubsystem.generated.h"
+
+class ABreakableTarget;
+
+/** Where the HUD draws the indicator of one unbroken target */
+struct FTargetIndicator
+{
+	/** Viewport pixels, clamped to the inner border when the target is off screen */
+	FVector2f ScreenPosition;
+	/** Unit direction from the viewport centre towards the target, for edge arrows */
+	FVector2f EdgeDirection;
+	/** Distance from the camera, in cm */
+	float Distance;
+	bool bOnScreen;
+};
+
+/**
+ * Screen indicators for every unbroken breakable target of the first local player.
+ * Target positions are kept in packed arrays with the on screen targets first: those are projected every frame,
+ * the off screen ones only at m_OffScreenUpdateRate, all in one batch (PhysicsCore::ProjectPointsBatch).
+ * The HUD reads the result from GetIndicators(), indices are not stable across frames.
+ */
+UCLASS(config=Game)
+class PHYSICS_API UTargetIndicatorSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Refreshes per second of the indicators of off screen targets */
+	UPROPERTY(config)
+	float m_OffScreenUpdateRate = 10.f;
+
+	/** Distance from the viewport border at which off screen indicators are drawn, in pixels */
+	UPROPERTY(config)
+	float m_EdgeMargin = 48.f;
+
+	/** USubsystem **/
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/** FTickableGameObject **/
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Starts tracking a target, does nothing if it already is. The location is read once, targets are not expected to move */
+	void AddTarget(ABreakableTarget* Target);
+	void RemoveTarget(ABreakableTarget* Target);
+
+	const TArray<FTargetIndicator>& GetIndicators() const { return m_Indicators; }
+
+	UFUNCTION(BlueprintPure, Category = Indicators)
+	int32 GetNumIndicators() const { return m_Indicators.Num(); }
+
+	UFUNCTION(BlueprintPure, Category = Indicators)
+	int32 GetNumOnScreen() const { return m_NumOnScreen; }
+
+	/** Blueprint access to one entry of GetIndicators() */
+	UFUNCTION(BlueprintPure, Category = Indicators)
+	void GetIndicator(int32 Index, FVector2D& ScreenPosition, FVector2D& EdgeDirection, float& Distance, bool& bOnScreen) const;
+
+protected:
+	void SwapEntries(int32 A, int32 B);
+
+	TArray<TWeakObjectPtr<ABreakableTarget>> m_Targets;
+	TMap<TWeakObjectPtr<ABreakableTarget>, int32> m_TargetIndices;
+	/** Entries [0, m_NumOnScreen) were on screen at their last update */
+	int32 m_NumOnScreen = 0;
+
+	TArray<float> m_X;
+	TArray<float> m_Y;
+	TArray<float> m_Z;
+
+	/** Batch outputs, only meaningful during Tick */
+	TArray<float> m_ScreenX;
+	TArray<float> m_ScreenY;
+	TArray<float> m_W;
+	TArray<float> m_DirX;
+	TArray<float> m_DirY;
+	TArray<float> m_Distance;
+	TArray<uint8> m_OnScreen;
+
+	TArray<FTargetIndicator> m_Indicators;
+
+	float m_OffScreenTimer = 0.f;
+	/** Set when a target is added so it gets an indicator on the next tick */
+	bool m_bRefreshAll = true;
+};
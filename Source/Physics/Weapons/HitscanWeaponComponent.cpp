@@ -8,28 +8,32 @@
 #include "PhysicsWeaponComponent.h"
 #include <Camera/CameraComponent.h>
 #include <Components/SphereComponent.h>
+#include "Profiling/PhysicsLatencyTracker.h"
 
-void UHitscanWeaponComponent::Fire()
+bool UHitscanWeaponComponent::FireShots(TConstArrayView<float> ShotAges)
 {
-	Super::Fire();
-
 	// @TODO: Add firing functionality
-	if (!GetOwner()){
-		return;
+	if (!Super::FireShots(ShotAges) || !GetOwner()){
+		return false;
 	}
 
 	const FVector Start = Character->FirstPersonCameraComponent->GetComponentLocation();
 	const FVector Forward = Character->FirstPersonCameraComponent->GetForwardVector();
 	const FVector End = Start + (Forward * m_Range);
 
-	FHitResult HitResult;
 	FCollisionQueryParams Params;
 
-	if (GetWorld()->LineTraceSingleByChannel(HitResult, Start, End, ECC_Visibility, Params))
+	// Traces are instant, shots of the same batch only differ by their age
+	for (int32 i = 0; i < ShotAges.Num(); ++i)
 	{
-		AActor* OtherActor = HitResult.GetActor();
-		ApplyDamage(OtherActor, HitResult,nullptr);
-		onHitscanImpact.Broadcast(OtherActor, HitResult.ImpactPoint, Forward);
+		FHitResult HitResult;
+		if (GetWorld()->LineTraceSingleByChannel(HitResult, Start, End, ECC_Visibility, Params))
+		{
+			FPhysicsLatencyTracker::RecordStage(FPhysicsLatencyTracker::GetCurrentId(), ELatencyStage::HIT);
+			AActor* OtherActor = HitResult.GetActor();
+			ApplyDamage(OtherActor, HitResult,nullptr);
+			onHitscanImpact.Broadcast(OtherActor, HitResult.ImpactPoint, Forward);
+		}
 	}
-	
+	return true;
 }
@@ -12,9 +12,9 @@ UCLASS(Blueprintable, BlueprintType, ClassGroup = (Custom), meta = (BlueprintSpa
 class PHYSICS_API UHitscanWeaponComponent : public UPhysicsWeaponComponent
 {
 	GENERATED_BODY()
-public:
+protected:
 	/** UPhysicsWeaponComponent **/
-	virtual void Fire() override;
+	virtual bool FireShots(TConstArrayView<float> ShotAges) override;
 public:
 	UPROPERTY(EditAnywhere)
 	float m_Range;
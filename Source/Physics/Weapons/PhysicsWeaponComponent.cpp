@@ -14,6 +14,14 @@
 #include <Components/SphereComponent.h>
 
 #include "PhysicsProjectile.h"
+#include "BreakableTarget.h"
+#include "Simulation/DebrisBakeSubsystem.h"
+#include "Core/GameplayMathConversions.h"
+#include "Telemetry/CombatTelemetry.h"
+#include "Weapons/WeaponInventoryComponent.h"
+#include "Profiling/PhysicsHitchDetector.h"
+#include "Profiling/PhysicsLatencyTracker.h"
+#include "PhysicsCosmetics.h"
 
 // Sets default values for this component's properties
 UPhysicsWeaponComponent::UPhysicsWeaponComponent()
@@ -30,10 +38,62 @@ void UPhysicsWeaponComponent::BeginPlay()
 
 void UPhysicsWeaponComponent::Fire()
 {
-	if (Character == nullptr || Character->GetController() == nullptr)
+	const float ShotAge = 0.f;
+	FireShots(MakeArrayView(&ShotAge, 1));
+}
+
+void UPhysicsWeaponComponent::UpdateFire(bool bTriggerHeld, double Now)
+{
+	PhysicsCore::FireParams Params;
+	Params.Mode = static_cast<PhysicsCore::FireMode>(m_FireMode);
+	Params.Interval = 1.0 / FMath::Max(m_FireRate, 0.1f);
+	Params.BurstCount = m_BurstCount;
+	Params.BurstCooldown = m_BurstCooldown;
+	Params.ChargeTime = m_ChargeTime;
+
+	TArray<double, TInlineAllocator<8>> ShotTimes;
+	ShotTimes.SetNumUninitialized(FMath::Max(m_MaxShotsPerFrame, 1));
+	const int32 NumShots = PhysicsCore::ScheduleShots(m_FireState, Params, bTriggerHeld, Now, ShotTimes.GetData(), ShotTimes.Num());
+	if (NumShots == 0)
 	{
 		return;
 	}
+
+	TArray<float, TInlineAllocator<8>> ShotAges;
+	for (int32 i = 0; i < NumShots; ++i)
+	{
+		ShotAges.Add(static_cast<float>(Now - ShotTimes[i]));
+	}
+
+	// The caller makes the trigger input current, so FIRE is measured from the press rather than from this tick
+	PHYSICS_HITCH_SCOPE(WeaponFire, GetWorld());
+	FireShots(ShotAges);
+}
+
+void UPhysicsWeaponComponent::ResetFireInput()
+{
+	m_FireState.bHeld = false;
+	m_FireState.BurstRemaining = 0;
+}
+
+bool UPhysicsWeaponComponent::FireShots(TConstArrayView<float> ShotAges)
+{
+	if (Character == nullptr || Character->GetController() == nullptr)
+	{
+		return false;
+	}
+
+	for (int32 i = 0; i < ShotAges.Num(); ++i)
+	{
+		FCombatTelemetry::Record(ECombatEvent::SHOT, Character, this, ShotAges[i], Character->GetActorLocation());
+	}
+	FPhysicsLatencyTracker::RecordStage(FPhysicsLatencyTracker::GetCurrentId(), ELatencyStage::FIRE);
+	m_ShotCount += ShotAges.Num();
+
+	if (!PhysicsCosmetics::IsEnabled(this))
+	{
+		return true;
+	}
 	
 	// Try and play the sound if specified
 	if (FireSound != nullptr)
@@ -51,54 +111,27 @@ void UPhysicsWeaponComponent::Fire()
 			AnimInstance->Montage_Play(FireAnimation, 1.f);
 		}
 	}
+	return true;
 }
 
 bool UPhysicsWeaponComponent::AttachWeapon(APhysicsCharacter* TargetCharacter)
 {
-	Character = TargetCharacter;
+	PHYSICS_HITCH_SCOPE(WeaponAttach, GetWorld());
 
-	// Check that the character is valid, and has no weapon component yet
-	if (Character == nullptr || Character->GetInstanceComponents().FindItemByClass<UPhysicsWeaponComponent>())
+	// The inventory attaches the weapon and routes the fire input to whichever weapon is equipped
+	if (TargetCharacter == nullptr)
 	{
 		return false;
 	}
-	
-	// Attach the weapon to the First Person Character
-	FAttachmentTransformRules AttachmentRules(EAttachmentRule::SnapToTarget, true);
-	AttachToComponent(Character->GetMesh1P(), AttachmentRules, FName(TEXT("GripPoint")));
-
-	// Set up action bindings
-	if (APlayerController* PlayerController = Cast<APlayerController>(Character->GetController()))
-	{
-		if (UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer()))
-		{
-			// Set the priority of the mapping to 1, so that it overrides the Jump action with the Fire action when using touch input
-			Subsystem->AddMappingContext(FireMappingContext, 1);
-		}
-
-		if (UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(PlayerController->InputComponent))
-		{
-			// Fire
-			EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Triggered, this, &UPhysicsWeaponComponent::Fire);
-		}
-	}
-
-	return true;
+	return TargetCharacter->GetWeaponInventory()->AddWeapon(this);
 }
 
 void UPhysicsWeaponComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	// ensure we have a character owner
-	if (Character != nullptr)
+	if (Character != nullptr && Character->GetWeaponInventory())
 	{
-		// remove the input mapping context from the Player Controller
-		if (APlayerController* PlayerController = Cast<APlayerController>(Character->GetController()))
-		{
-			if (UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer()))
-			{
-				Subsystem->RemoveMappingContext(FireMappingContext);
-			}
-		}
+		Character->GetWeaponInventory()->RemoveWeapon(this);
 	}
 
 	// maintain the EndPlay call chain
@@ -110,14 +143,32 @@ void UPhysicsWeaponComponent::ApplyDamage(AActor* OtherActor, const FHitResult&
 	if (!OtherActor || !m_WeaponDamageType)
 		return;
 
+	// Baked debris wakes up and the damage goes to the target it came from
+	if (UDebrisBakeSubsystem* DebrisBake = GetWorld()->GetSubsystem<UDebrisBakeSubsystem>())
+	{
+		if (m_WeaponDamageType->m_ImpulseType == EImpulseType::RADIAL && Projectile)
+		{
+			DebrisBake->WakeInRadius(Projectile->GetActorLocation(), Projectile->m_Radius);
+		}
+		else if (ABreakableTarget* Target = DebrisBake->WakeFromHit(HitInfo))
+		{
+			OtherActor = Target;
+		}
+	}
+
+	FCombatTelemetry::Record(ECombatEvent::HIT, Character, OtherActor, m_WeaponDamageType->m_Damage, HitInfo.ImpactPoint);
+	FPhysicsLatencyTracker::RecordStage(FPhysicsLatencyTracker::GetCurrentId(), ELatencyStage::DAMAGE);
+
 	switch (m_WeaponDamageType->m_ImpulseType)
 	{
 	case EImpulseType::RAY:
-		UGameplayStatics::ApplyPointDamage(OtherActor,m_WeaponDamageType->m_Damage,HitInfo.ImpactNormal * -1.0f, HitInfo,
+		UGameplayStatics::ApplyPointDamage(OtherActor,m_WeaponDamageType->m_Damage,
+			PhysicsCore::ToEngine(PhysicsCore::RayDamageDirection(PhysicsCore::ToCore(HitInfo.ImpactNormal))), HitInfo,
 			Character->GetController(), Character, m_WeaponDamageType->m_DamageType);
 		break;
 	case EImpulseType::POINT:
-		UGameplayStatics::ApplyPointDamage(OtherActor,m_WeaponDamageType->m_Damage,Projectile->GetVelocity(), HitInfo,
+		UGameplayStatics::ApplyPointDamage(OtherActor,m_WeaponDamageType->m_Damage,
+			Projectile->GetVelocity(), HitInfo,
 			Character->GetController(),Projectile, m_WeaponDamageType->m_DamageType);
 		break;
 	case EImpulseType::RADIAL:
@@ -6,15 +6,30 @@
 #include "PhysicsProjectile.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "WeaponDamageType.h"
+#include "Core/GameplayMath.h"
 #include "PhysicsWeaponComponent.generated.h"
 
 class APhysicsCharacter;
 
+UENUM(BlueprintType)
+enum class EFireMode : uint8
+{
+	/** Fires at m_FireRate while the trigger is held */
+	AUTO,
+	/** Fires m_BurstCount shots at m_FireRate per press */
+	BURST,
+	/** Fires once on release after holding for m_ChargeTime */
+	CHARGE
+};
+
 UCLASS(Blueprintable, BlueprintType, ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class PHYSICS_API UPhysicsWeaponComponent : public USkeletalMeshComponent
 {
 	GENERATED_BODY()
 
+	/** Sets Character when the weapon is added to an inventory */
+	friend class UWeaponInventoryComponent;
+
 public:
 
 	/** Sound to play each time we fire */
@@ -41,16 +56,49 @@ public:
 	UPROPERTY(Instanced, EditAnywhere, BlueprintReadOnly, Category=Damage, meta=(AllowPrivateAccess = "true"))
 	UWeaponDamageType* m_WeaponDamageType;
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Fire)
+	EFireMode m_FireMode = EFireMode::AUTO;
+
+	/** Shots per second, whatever the frame rate */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Fire, meta=(ClampMin = "0.1"))
+	float m_FireRate = 8.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Fire, meta=(ClampMin = "1", EditCondition = "m_FireMode == EFireMode::BURST"))
+	int32 m_BurstCount = 3;
+
+	/** Wait after the last shot of a burst, in seconds */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Fire, meta=(ClampMin = "0", EditCondition = "m_FireMode == EFireMode::BURST"))
+	float m_BurstCooldown = 0.3f;
+
+	/** Hold time before a release fires, in seconds */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Fire, meta=(ClampMin = "0", EditCondition = "m_FireMode == EFireMode::CHARGE"))
+	float m_ChargeTime = 0.5f;
+
+	/** Shots a single frame can emit, the rest of a long frame is dropped */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Fire, meta=(ClampMin = "1"))
+	int32 m_MaxShotsPerFrame = 4;
+
 	/** Sets default values for this component's properties */
 	UPhysicsWeaponComponent();
 
-	/** Attaches the actor to a FirstPersonCharacter */
+	/** Adds the weapon to the inventory of a FirstPersonCharacter and equips it */
 	UFUNCTION(BlueprintCallable, Category="Weapon")
 	bool AttachWeapon(APhysicsCharacter* TargetCharacter);
 
-	/** Make the weapon Fire a Projectile */
+	/** Fires one shot right now, outside of the fire schedule */
 	UFUNCTION(BlueprintCallable, Category="Weapon")
-	virtual void Fire();
+	void Fire();
+
+	/**
+	 * Advances the fire schedule to Now with the trigger state of this frame and fires the shots that are due, as one batch.
+	 * The batch is correlated with the current FPhysicsLatencyTracker id, if any.
+	 */
+	void UpdateFire(bool bTriggerHeld, double Now);
+
+	/** Forgets the trigger state, a held trigger has to be pressed again */
+	void ResetFireInput();
+
+	int32 GetShotCount() const { return m_ShotCount; }
 
 	void ApplyDamage(AActor* OtherActor, const FHitResult& HitInfo, APhysicsProjectile* Projectile) const;
 	
@@ -62,8 +110,17 @@ protected:
 	UFUNCTION()
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
+	/**
+	 * Fires one batch of shots, ShotAges holds how long ago each shot happened within the frame, in seconds.
+	 * Cosmetics play once per batch. Returns false when the weapon can not fire, overrides stop there.
+	 */
+	virtual bool FireShots(TConstArrayView<float> ShotAges);
+
 protected:
 	/** The Character holding this weapon*/
 	UPROPERTY()
 	APhysicsCharacter* Character;
+
+	PhysicsCore::FireState m_FireState;
+	int32 m_ShotCount = 0;
 };
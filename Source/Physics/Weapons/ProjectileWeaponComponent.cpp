@@ -4,32 +4,107 @@
 #include "Weapons/ProjectileWeaponComponent.h"
 #include "PhysicsCharacter.h"
 #include "PhysicsProjectile.h"
+#include "Core/GameplayMathConversions.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "Profiling/PhysicsHitchDetector.h"
+#include "Profiling/PhysicsLatencyTracker.h"
 
-void UProjectileWeaponComponent::Fire()
+bool UProjectileWeaponComponent::FireShots(TConstArrayView<float> ShotAges)
 {
-	Super::Fire();
+	if (!Super::FireShots(ShotAges))
+	{
+		return false;
+	}
 
 	// Try and fire a projectile
 	if (m_ProjectileClass != nullptr)
 	{
 		UWorld* const World = GetWorld();
-		if (World != nullptr)
+		FVector SpawnLocation;
+		FRotator SpawnRotation;
+		if (World != nullptr && GetMuzzleTransform(SpawnLocation, SpawnRotation))
 		{
-			APlayerController* PlayerController = Cast<APlayerController>(Character->GetController());
-			const FRotator SpawnRotation = PlayerController->PlayerCameraManager->GetCameraRotation();
-			// MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
-			const FVector SpawnLocation = GetOwner()->GetActorLocation() + SpawnRotation.RotateVector(MuzzleOffset);
-
 			//Set Spawn Collision Handling Override
 			FActorSpawnParameters ActorSpawnParams;
 			ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
 
-			// Spawn the projectile at the muzzle
-			APhysicsProjectile* ProjectileActor = World->SpawnActor<APhysicsProjectile>(m_ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
-			if (ProjectileActor)
+			PHYSICS_HITCH_SCOPE(ProjectileSpawn, GetWorld());
+
+			// Shots fired earlier in the frame leave from where the character was at the time, relative to its current location
+			// so the float batch keeps full precision far from the origin
+			const FVector Origin = GetOwner()->GetActorLocation();
+			const FVector OwnerVelocity = GetOwner()->GetVelocity();
+			const PhysicsCore::Rotator Aim = PhysicsCore::ToCore(SpawnRotation);
+			TArray<float, TInlineAllocator<8>> MuzzleX, MuzzleY, MuzzleZ;
+			TArray<PhysicsCore::Rotator, TInlineAllocator<8>> Aims;
+			for (const float ShotAge : ShotAges)
 			{
+				const FVector Rewind = -OwnerVelocity * ShotAge;
+				MuzzleX.Add(static_cast<float>(Rewind.X));
+				MuzzleY.Add(static_cast<float>(Rewind.Y));
+				MuzzleZ.Add(static_cast<float>(Rewind.Z));
+				Aims.Add(Aim);
+			}
+			PhysicsCore::MuzzleLocationBatch(MuzzleX.GetData(), MuzzleY.GetData(), MuzzleZ.GetData(), Aims.GetData(), ShotAges.Num(), PhysicsCore::ToCore(MuzzleOffset));
+
+			for (int32 i = 0; i < ShotAges.Num(); ++i)
+			{
+				const float ShotAge = ShotAges[i];
+				SpawnLocation = Origin + FVector(MuzzleX[i], MuzzleY[i], MuzzleZ[i]);
+
+				// Spawn the projectile at the muzzle
+				APhysicsProjectile* ProjectileActor = World->SpawnActor<APhysicsProjectile>(m_ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
+				if (!ProjectileActor)
+				{
+					continue;
+				}
 				ProjectileActor->m_OwnerWeapon = this;
+				ProjectileActor->m_LatencyId = FPhysicsLatencyTracker::GetCurrentId();
+
+				// Shots fired earlier in the frame catch up on the flight they missed. The projectile is moved along the chord
+				// of its arc with a sweep, so a blocking hit on the way still reaches OnHit
+				UProjectileMovementComponent* Movement = ProjectileActor->GetProjectileMovement();
+				if (ShotAge > UE_KINDA_SMALL_NUMBER)
+				{
+					const PhysicsCore::Vec3 Velocity = PhysicsCore::ToCore(Movement->Velocity);
+					const PhysicsCore::Vec3 Gravity(0.f, 0.f, static_cast<float>(Movement->GetGravityZ()));
+					const FVector Flight = PhysicsCore::ToEngine(PhysicsCore::BallisticPosition({}, Velocity, Gravity, ShotAge));
+					FHitResult Hit;
+					ProjectileActor->SetActorLocation(ProjectileActor->GetActorLocation() + Flight, true, &Hit);
+					if (IsValid(ProjectileActor) && !Hit.bBlockingHit)
+					{
+						Movement->Velocity = PhysicsCore::ToEngine(PhysicsCore::BallisticVelocity(Velocity, Gravity, ShotAge));
+					}
+				}
 			}
 		}
 	}
+	return true;
+}
+
+bool UProjectileWeaponComponent::GetMuzzleTransform(FVector& OutLocation, FRotator& OutRotation) const
+{
+	if (Character == nullptr || GetOwner() == nullptr)
+	{
+		return false;
+	}
+
+	APlayerController* PlayerController = Cast<APlayerController>(Character->GetController());
+	if (PlayerController != nullptr && PlayerController->PlayerCameraManager != nullptr)
+	{
+		OutRotation = PlayerController->PlayerCameraManager->GetCameraRotation();
+	}
+	else if (Character->GetController() != nullptr)
+	{
+		// AI controlled characters have no camera manager, their control rotation is the aim
+		OutRotation = Character->GetControlRotation();
+	}
+	else
+	{
+		return false;
+	}
+
+	// MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
+	OutLocation = GetOwner()->GetActorLocation() + PhysicsCore::ToEngine(PhysicsCore::RotateVector(PhysicsCore::ToCore(OutRotation), PhysicsCore::ToCore(MuzzleOffset)));
+	return true;
 }
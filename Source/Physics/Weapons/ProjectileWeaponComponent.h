@@ -16,6 +16,10 @@ public:
 	TSubclassOf<class APhysicsProjectile> m_ProjectileClass;
 
 public:
+	/** Computes where a projectile fired right now would spawn, returns false if the weapon is not held */
+	bool GetMuzzleTransform(FVector& OutLocation, FRotator& OutRotation) const;
+
+protected:
 	/** UPhysicsWeaponComponent **/
-	virtual void Fire() override;
+	virtual bool FireShots(TConstArrayView<float> ShotAges) override;
 };
@@ -0,0 +1,219 @@
+#include "Weapons/TrajectoryPreviewComponent.h"
+#include "Weapons/ProjectileWeaponComponent.h"
+#include "PhysicsProjectile.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "Engine/World.h"
+#include "Engine/OverlapResult.h"
+#include "Core/GameplayMathConversions.h"
+#include "PhysicsCosmetics.h"
+
+UTrajectoryPreviewComponent::UTrajectoryPreviewComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetGenerateOverlapEvents(false);
+	CastShadow = false;
+	bCastDynamicShadow = false;
+}
+
+void UTrajectoryPreviewComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!PhysicsCosmetics::IsEnabled(this))
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	// Instances are written in world space, so the component itself must not follow the weapon around
+	SetUsingAbsoluteLocation(true);
+	SetUsingAbsoluteRotation(true);
+	SetUsingAbsoluteScale(true);
+	SetWorldTransform(FTransform::Identity);
+
+	if (GetOwner())
+	{
+		m_Weapon = GetOwner()->FindComponentByClass<UProjectileWeaponComponent>();
+	}
+
+	const int32 MaxPoints = (m_SamplesPerLeg + 1) * (m_MaxBounces + 1);
+	m_ArcPoints.Reserve(MaxPoints);
+	m_OffsetsX.SetNumUninitialized(m_SamplesPerLeg);
+	m_OffsetsY.SetNumUninitialized(m_SamplesPerLeg);
+	m_OffsetsZ.SetNumUninitialized(m_SamplesPerLeg);
+	m_InstanceTransforms.Init(FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector), MaxPoints);
+	ClearInstances();
+	AddInstances(m_InstanceTransforms, false, true);
+	SetVisibility(false);
+}
+
+void UTrajectoryPreviewComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	FVector MuzzleLocation;
+	FRotator AimRotation;
+	if (!m_Weapon || !m_Weapon->IsActive() || !m_Weapon->m_ProjectileClass || !m_Weapon->GetMuzzleTransform(MuzzleLocation, AimRotation))
+	{
+		if (IsVisible())
+		{
+			SetVisibility(false);
+			m_bArcValid = false;
+		}
+		return;
+	}
+
+	const FVector AimDirection = AimRotation.Vector();
+	if (m_bArcValid
+		&& FVector::DistSquared(MuzzleLocation, m_LastMuzzleLocation) < FMath::Square(m_RecomputeDistance)
+		&& FVector::DotProduct(AimDirection, m_LastAimDirection) > FMath::Cos(FMath::DegreesToRadians(m_RecomputeAngle)))
+	{
+		return;
+	}
+
+	const UProjectileMovementComponent* Movement = GetDefault<APhysicsProjectile>(m_Weapon->m_ProjectileClass)->GetProjectileMovement();
+	if (!Movement)
+	{
+		return;
+	}
+
+	// Same launch velocity UProjectileMovementComponent::InitializeComponent computes for a local space initial velocity
+	const FVector LocalVelocity = Movement->InitialSpeed > 0.f ? Movement->Velocity.GetSafeNormal() * Movement->InitialSpeed : Movement->Velocity;
+	ComputeArc(MuzzleLocation, AimRotation.RotateVector(LocalVelocity));
+	UpdateInstances();
+
+	m_LastMuzzleLocation = MuzzleLocation;
+	m_LastAimDirection = AimDirection;
+	m_bArcValid = true;
+	SetVisibility(true);
+}
+
+void UTrajectoryPreviewComponent::ComputeArc(const FVector& Start, const FVector& LaunchVelocity)
+{
+	const UProjectileMovementComponent* Movement = GetDefault<APhysicsProjectile>(m_Weapon->m_ProjectileClass)->GetProjectileMovement();
+	const FVector Gravity(0.f, 0.f, GetWorld()->GetGravityZ() * Movement->ProjectileGravityScale);
+
+	m_ArcPoints.Reset();
+
+	FVector LegStart = Start;
+	FVector LegVelocity = LaunchVelocity;
+	for (int32 Leg = 0; Leg <= m_MaxBounces; ++Leg)
+	{
+		// Closed form p(t) = p0 + v0 * t + g * t^2 / 2, evaluated for the whole leg at once relative to its start
+		// (MaxSpeed clamping of the movement component is ignored, the preview only has to be close)
+		PhysicsCore::BallisticPositionsBatch(m_OffsetsX.GetData(), m_OffsetsY.GetData(), m_OffsetsZ.GetData(), m_SamplesPerLeg,
+			PhysicsCore::Vec3(), PhysicsCore::ToCore(LegVelocity), PhysicsCore::ToCore(Gravity), m_SampleInterval);
+
+		const int32 FirstPoint = m_ArcPoints.Num();
+		m_ArcPoints.AddUninitialized(m_SamplesPerLeg);
+		FVector* Points = m_ArcPoints.GetData() + FirstPoint;
+		for (int32 i = 0; i < m_SamplesPerLeg; ++i)
+		{
+			Points[i] = LegStart + FVector(m_OffsetsX[i], m_OffsetsY[i], m_OffsetsZ[i]);
+		}
+
+		FHitResult Hit;
+		const int32 HitSegment = TraceLeg(FirstPoint, Hit);
+		if (HitSegment == INDEX_NONE)
+		{
+			break;
+		}
+
+		// Drop the samples past the impact and end the leg on the impact point
+		m_ArcPoints.SetNum(FirstPoint + HitSegment + 1, EAllowShrinking::No);
+		m_ArcPoints.Add(Hit.Location);
+
+		if (!Movement->bShouldBounce)
+		{
+			break;
+		}
+
+		const float ImpactTime = (HitSegment + Hit.Time) * m_SampleInterval;
+		const PhysicsCore::Vec3 ImpactVelocity = PhysicsCore::BallisticVelocity(PhysicsCore::ToCore(LegVelocity), PhysicsCore::ToCore(Gravity), ImpactTime);
+		LegVelocity = PhysicsCore::ToEngine(PhysicsCore::BounceVelocity(ImpactVelocity, PhysicsCore::ToCore(Hit.Normal), Movement->Bounciness, Movement->Friction));
+		LegStart = Hit.Location + Hit.Normal * KINDA_SMALL_NUMBER;
+
+		if (LegVelocity.SizeSquared() < FMath::Square(Movement->BounceVelocityStopSimulatingThreshold))
+		{
+			break;
+		}
+	}
+}
+
+int32 UTrajectoryPreviewComponent::TraceLeg(int32 FirstPoint, FHitResult& OutHit) const
+{
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(TrajectoryPreview), false);
+	if (m_Weapon)
+	{
+		Params.AddIgnoredActor(m_Weapon->GetOwner());
+		Params.AddIgnoredActor(m_Weapon->GetAttachmentRootActor());
+	}
+
+	const int32 NumPoints = m_ArcPoints.Num() - FirstPoint;
+	if (NumPoints < 2)
+	{
+		return INDEX_NONE;
+	}
+
+	// Single broad phase query for the whole leg
+	const FBox LegBounds = FBox(m_ArcPoints.GetData() + FirstPoint, NumPoints).ExpandBy(1.0);
+	TArray<FOverlapResult> Overlaps;
+	GetWorld()->OverlapMultiByChannel(Overlaps, LegBounds.GetCenter(), FQuat::Identity, m_TraceChannel, FCollisionShape::MakeBox(LegBounds.GetExtent()), Params);
+
+	TArray<TPair<UPrimitiveComponent*, FBox>, TInlineAllocator<16>> Candidates;
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		UPrimitiveComponent* Component = Overlap.GetComponent();
+		if (Overlap.bBlockingHit && Component)
+		{
+			Candidates.Emplace(Component, Component->Bounds.GetBox());
+		}
+	}
+	if (Candidates.IsEmpty())
+	{
+		return INDEX_NONE;
+	}
+
+	// Segments in flight order, the closest hit among the candidates of the first blocked segment wins
+	for (int32 i = FirstPoint; i + 1 < m_ArcPoints.Num(); ++i)
+	{
+		const FVector& Start = m_ArcPoints[i];
+		const FVector& End = m_ArcPoints[i + 1];
+		bool bBlocked = false;
+		for (const TPair<UPrimitiveComponent*, FBox>& Candidate : Candidates)
+		{
+			FHitResult Hit;
+			if (FMath::LineBoxIntersection(Candidate.Value, Start, End, End - Start)
+				&& Candidate.Key->LineTraceComponent(Hit, Start, End, Params)
+				&& (!bBlocked || Hit.Time < OutHit.Time))
+			{
+				OutHit = Hit;
+				bBlocked = true;
+			}
+		}
+		if (bBlocked)
+		{
+			return i - FirstPoint;
+		}
+	}
+	return INDEX_NONE;
+}
+
+void UTrajectoryPreviewComponent::UpdateInstances()
+{
+	for (int32 i = 0; i < m_InstanceTransforms.Num(); ++i)
+	{
+		if (m_ArcPoints.IsValidIndex(i))
+		{
+			m_InstanceTransforms[i] = FTransform(FQuat::Identity, m_ArcPoints[i], m_PointScale);
+		}
+		else
+		{
+			// Unused instances stay allocated but collapse to nothing, so the instance count never changes
+			m_InstanceTransforms[i] = FTransform(FQuat::Identity, m_ArcPoints.Num() ? m_ArcPoints.Last() : FVector::ZeroVector, FVector::ZeroVector);
+		}
+	}
+	BatchUpdateInstancesTransforms(0, m_InstanceTransforms, true, true, true);
+}
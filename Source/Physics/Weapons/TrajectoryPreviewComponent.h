@@ -0,0 +1,89 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "TrajectoryPreviewComponent.generated.h"
+
+class UProjectileWeaponComponent;
+
+/**
+ * Draws the arc a projectile weapon would fire along, one mesh instance per sample point.
+ * The arc is evaluated in closed form from the projectile class defaults instead of simulating it,
+ * and only recomputed when the muzzle moves or turns past the configured thresholds.
+ * Add it to the same actor as the UProjectileWeaponComponent.
+ */
+UCLASS(Blueprintable, BlueprintType, ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class PHYSICS_API UTrajectoryPreviewComponent : public UInstancedStaticMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+	/** Time between two sample points of the arc, in seconds */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Preview, meta = (ClampMin = "0.01"))
+	float m_SampleInterval = 0.05f;
+
+	/** Sample points evaluated per flight leg (first flight and every bounce) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Preview, meta = (ClampMin = "2"))
+	int32 m_SamplesPerLeg = 24;
+
+	/** Number of bounces previewed after the first impact */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Preview, meta = (ClampMin = "0"))
+	int32 m_MaxBounces = 1;
+
+	/** Muzzle displacement that forces a recompute, in cm */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Preview)
+	float m_RecomputeDistance = 5.0f;
+
+	/** Aim rotation that forces a recompute, in degrees */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Preview)
+	float m_RecomputeAngle = 0.5f;
+
+	/** Scale applied to every sample mesh instance */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Preview)
+	FVector m_PointScale = FVector(0.05f);
+
+	/** Trace channel used to find impacts */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Preview)
+	TEnumAsByte<ECollisionChannel> m_TraceChannel = ECC_Visibility;
+
+	UTrajectoryPreviewComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Forces the arc to be recomputed on the next tick */
+	UFUNCTION(BlueprintCallable, Category = Preview)
+	void Invalidate() { m_bArcValid = false; }
+
+	/** World space points of the last computed arc */
+	const TArray<FVector>& GetArcPoints() const { return m_ArcPoints; }
+
+protected:
+	virtual void BeginPlay() override;
+
+	/** Rebuilds m_ArcPoints from the muzzle location and launch velocity */
+	void ComputeArc(const FVector& Start, const FVector& LaunchVelocity);
+
+	/**
+	 * Finds the first blocked segment of one leg, returns its index or INDEX_NONE.
+	 * One overlap query over the bounds of the leg gathers the candidate components, the segments are then tested in order
+	 * against the candidate bounds and only traced against the components whose bounds they cross.
+	 */
+	int32 TraceLeg(int32 FirstPoint, FHitResult& OutHit) const;
+
+	/** Pushes m_ArcPoints to the mesh instances in one batch */
+	void UpdateInstances();
+
+	UPROPERTY()
+	UProjectileWeaponComponent* m_Weapon;
+
+	TArray<FVector> m_ArcPoints;
+	/** Per leg scratch, one array per axis for the batch evaluation */
+	TArray<float> m_OffsetsX;
+	TArray<float> m_OffsetsY;
+	TArray<float> m_OffsetsZ;
+	TArray<FTransform> m_InstanceTransforms;
+
+	FVector m_LastMuzzleLocation = FVector::ZeroVector;
+	FVector m_LastAimDirection = FVector::ZeroVector;
+	bool m_bArcValid = false;
+};
@@ -0,0 +1,307 @@
+#include "Weapons/WeaponInventoryComponent.h"
+#include "Weapons/PhysicsWeaponComponent.h"
+#include "PhysicsCharacter.h"
+#include "PhysicsPickUpComponent.h"
+#include "PhysicsStats.h"
+#include "Profiling/PhysicsHitchDetector.h"
+#include "Profiling/PhysicsLatencyTracker.h"
+#include "EnhancedInputComponent.h"
+#include "EnhancedInputSubsystems.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/PlatformTime.h"
+
+DECLARE_CYCLE_STAT(TEXT("Weapon Swap"), STAT_WeaponSwap, STATGROUP_PhysicsGame);
+
+UWeaponInventoryComponent::UWeaponInventoryComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+}
+
+void UWeaponInventoryComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	m_Weapons.Reserve(m_StartingWeapons.Num());
+	for (const TSubclassOf<AActor>& PickUpClass : m_StartingWeapons)
+	{
+		AddWeaponFromClass(PickUpClass);
+	}
+	EquipWeapon(0);
+}
+
+void UWeaponInventoryComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	RemoveMappingContexts();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+APhysicsCharacter* UWeaponInventoryComponent::GetCharacter() const
+{
+	return Cast<APhysicsCharacter>(GetOwner());
+}
+
+bool UWeaponInventoryComponent::AddWeapon(UPhysicsWeaponComponent* Weapon)
+{
+	APhysicsCharacter* Character = GetCharacter();
+	if (!Character || !Weapon || m_Weapons.Contains(Weapon))
+	{
+		return false;
+	}
+
+	for (const UPhysicsWeaponComponent* Owned : m_Weapons)
+	{
+		if (Owned->GetClass() == Weapon->GetClass())
+		{
+			return false;
+		}
+	}
+
+	// Attach the weapon to the First Person Character
+	Weapon->Character = Character;
+	FAttachmentTransformRules AttachmentRules(EAttachmentRule::SnapToTarget, true);
+	Weapon->AttachToComponent(Character->GetMesh1P(), AttachmentRules, FName(TEXT("GripPoint")));
+
+	m_Weapons.Add(Weapon);
+	SetWeaponActive(Weapon, false);
+	BindInput();
+
+	// A picked up weapon goes straight to the hands, same as before the inventory existed
+	EquipWeapon(m_Weapons.Num() - 1);
+	return true;
+}
+
+UPhysicsWeaponComponent* UWeaponInventoryComponent::AddWeaponFromClass(TSubclassOf<AActor> PickUpClass)
+{
+	PHYSICS_HITCH_SCOPE(WeaponAttach, GetWorld());
+
+	APhysicsCharacter* Character = GetCharacter();
+	if (!Character || !PickUpClass)
+	{
+		return nullptr;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AActor* WeaponActor = GetWorld()->SpawnActor<AActor>(PickUpClass, Character->GetActorTransform(), SpawnParams);
+	if (!WeaponActor)
+	{
+		return nullptr;
+	}
+
+	// The pickup sphere would otherwise hand the weapon to whichever character walks into it
+	if (UPhysicsPickUpComponent* PickUp = WeaponActor->FindComponentByClass<UPhysicsPickUpComponent>())
+	{
+		PickUp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	}
+
+	UPhysicsWeaponComponent* Weapon = WeaponActor->FindComponentByClass<UPhysicsWeaponComponent>();
+	if (!Weapon || !AddWeapon(Weapon))
+	{
+		WeaponActor->Destroy();
+		return nullptr;
+	}
+	return Weapon;
+}
+
+void UWeaponInventoryComponent::RemoveWeapon(UPhysicsWeaponComponent* Weapon)
+{
+	const int32 Index = m_Weapons.Find(Weapon);
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	m_Weapons.RemoveAt(Index);
+	if (m_Weapons.IsEmpty())
+	{
+		m_ActiveIndex = INDEX_NONE;
+		RemoveMappingContexts();
+	}
+	else if (Index == m_ActiveIndex)
+	{
+		m_ActiveIndex = INDEX_NONE;
+		EquipWeapon(FMath::Min(Index, m_Weapons.Num() - 1));
+	}
+	else if (Index < m_ActiveIndex)
+	{
+		--m_ActiveIndex;
+	}
+}
+
+bool UWeaponInventoryComponent::EquipWeapon(int32 Index)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WeaponSwap);
+
+	if (!m_Weapons.IsValidIndex(Index) || Index == m_ActiveIndex)
+	{
+		return false;
+	}
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	if (UPhysicsWeaponComponent* Previous = GetActiveWeapon())
+	{
+		SetWeaponActive(Previous, false);
+	}
+	m_ActiveIndex = Index;
+	SetWeaponActive(m_Weapons[Index], true);
+	m_bWaitForRelease = m_bTriggerHeld;
+	m_TriggerLatencyId = 0;
+
+	const double SwapUs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0;
+	++m_SwapCount;
+	m_SwapTimeTotalUs += SwapUs;
+	m_SwapTimeMaxUs = FMath::Max(m_SwapTimeMaxUs, SwapUs);
+	return true;
+}
+
+void UWeaponInventoryComponent::NextWeapon()
+{
+	if (m_Weapons.Num() > 1)
+	{
+		EquipWeapon((m_ActiveIndex + 1) % m_Weapons.Num());
+	}
+}
+
+void UWeaponInventoryComponent::PreviousWeapon()
+{
+	if (m_Weapons.Num() > 1)
+	{
+		EquipWeapon((m_ActiveIndex + m_Weapons.Num() - 1) % m_Weapons.Num());
+	}
+}
+
+void UWeaponInventoryComponent::Fire()
+{
+	PHYSICS_HITCH_SCOPE(WeaponFire, GetWorld());
+	const FPhysicsLatencyTracker::FScope LatencyScope(FPhysicsLatencyTracker::BeginInput());
+
+	if (UPhysicsWeaponComponent* Weapon = GetActiveWeapon())
+	{
+		Weapon->Fire();
+	}
+}
+
+void UWeaponInventoryComponent::SetTriggerHeld(bool bHeld)
+{
+	if (bHeld == m_bTriggerHeld)
+	{
+		return;
+	}
+	m_bTriggerHeld = bHeld;
+	m_bWaitForRelease &= bHeld;
+
+	// Charge weapons fire on release, the others on press. Shots fired later by the schedule keep the id of that input
+	const UPhysicsWeaponComponent* Weapon = GetActiveWeapon();
+	const bool bFiringEdge = Weapon && (Weapon->m_FireMode == EFireMode::CHARGE ? !bHeld : bHeld);
+	if (bFiringEdge)
+	{
+		m_TriggerLatencyId = FPhysicsLatencyTracker::BeginInput();
+	}
+}
+
+void UWeaponInventoryComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	UPhysicsWeaponComponent* Weapon = GetActiveWeapon();
+	if (!Weapon)
+	{
+		return;
+	}
+
+	// Only the first batch after the input measures its latency, repeating auto fire is not a new input
+	const int32 ShotCount = Weapon->GetShotCount();
+	const FPhysicsLatencyTracker::FScope LatencyScope(m_TriggerLatencyId);
+	Weapon->UpdateFire(m_bTriggerHeld && !m_bWaitForRelease, GetWorld()->GetTimeSeconds());
+	if (Weapon->GetShotCount() != ShotCount)
+	{
+		m_TriggerLatencyId = 0;
+	}
+}
+
+int32 UWeaponInventoryComponent::GetShotCount() const
+{
+	int32 ShotCount = 0;
+	for (const UPhysicsWeaponComponent* Weapon : m_Weapons)
+	{
+		ShotCount += Weapon->GetShotCount();
+	}
+	return ShotCount;
+}
+
+void UWeaponInventoryComponent::SetWeaponActive(UPhysicsWeaponComponent* Weapon, bool bActive) const
+{
+	// Children follow, so components added next to the weapon (like the trajectory preview) are hidden with it
+	Weapon->SetVisibility(bActive, true);
+	Weapon->SetActive(bActive);
+	Weapon->SetComponentTickEnabled(bActive);
+	// Swapping cancels bursts and charges, EquipWeapon makes a held trigger wait for its release
+	Weapon->ResetFireInput();
+}
+
+void UWeaponInventoryComponent::BindInput()
+{
+	const APhysicsCharacter* Character = GetCharacter();
+	APlayerController* PlayerController = Character ? Cast<APlayerController>(Character->GetController()) : nullptr;
+	if (!PlayerController)
+	{
+		return;
+	}
+
+	UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(PlayerController->InputComponent);
+	if (PlayerController != m_BoundController.Get())
+	{
+		RemoveMappingContexts();
+		m_BoundActions.Reset();
+		m_BoundController = PlayerController;
+
+		if (EnhancedInputComponent)
+		{
+			if (NextWeaponAction)
+			{
+				EnhancedInputComponent->BindAction(NextWeaponAction, ETriggerEvent::Started, this, &UWeaponInventoryComponent::NextWeapon);
+			}
+			if (PreviousWeaponAction)
+			{
+				EnhancedInputComponent->BindAction(PreviousWeaponAction, ETriggerEvent::Started, this, &UWeaponInventoryComponent::PreviousWeapon);
+			}
+		}
+	}
+
+	UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer());
+	for (const UPhysicsWeaponComponent* Weapon : m_Weapons)
+	{
+		if (Subsystem && Weapon->FireMappingContext && !m_AddedContexts.Contains(Weapon->FireMappingContext))
+		{
+			// Set the priority of the mapping to 1, so that it overrides the Jump action with the Fire action when using touch input
+			Subsystem->AddMappingContext(Weapon->FireMappingContext, 1);
+			m_AddedContexts.Add(Weapon->FireMappingContext);
+		}
+
+		if (EnhancedInputComponent && Weapon->FireAction && !m_BoundActions.Contains(Weapon->FireAction))
+		{
+			EnhancedInputComponent->BindAction(Weapon->FireAction, ETriggerEvent::Started, this, &UWeaponInventoryComponent::PressTrigger);
+			EnhancedInputComponent->BindAction(Weapon->FireAction, ETriggerEvent::Completed, this, &UWeaponInventoryComponent::ReleaseTrigger);
+			EnhancedInputComponent->BindAction(Weapon->FireAction, ETriggerEvent::Canceled, this, &UWeaponInventoryComponent::ReleaseTrigger);
+			m_BoundActions.Add(Weapon->FireAction);
+		}
+	}
+}
+
+void UWeaponInventoryComponent::RemoveMappingContexts()
+{
+	const APlayerController* PlayerController = m_BoundController.Get();
+	UEnhancedInputLocalPlayerSubsystem* Subsystem = PlayerController ? ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer()) : nullptr;
+	if (Subsystem)
+	{
+		for (UInputMappingContext* Context : m_AddedContexts)
+		{
+			Subsystem->RemoveMappingContext(Context);
+		}
+	}
+	m_AddedContexts.Reset();
+}
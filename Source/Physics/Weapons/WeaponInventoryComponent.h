@@ -0,0 +1,121 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "WeaponInventoryComponent.generated.h"
+
+class APhysicsCharacter;
+class APlayerController;
+class UPhysicsWeaponComponent;
+class UInputAction;
+class UInputMappingContext;
+
+/**
+ * Weapons owned by an APhysicsCharacter.
+ * Every weapon is instantiated and attached once when it is added, input is bound once per distinct fire action and
+ * routed to the active weapon, so swapping only toggles visibility and activation.
+ * The fire input only tracks whether the trigger is held, the active weapon turns that into shots at its own rate on tick.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class PHYSICS_API UWeaponInventoryComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	/** Pickup actors spawned and added on begin play, the first one is equipped */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Inventory)
+	TArray<TSubclassOf<AActor>> m_StartingWeapons;
+
+	/** Equips the next weapon */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input)
+	UInputAction* NextWeaponAction;
+
+	/** Equips the previous weapon */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input)
+	UInputAction* PreviousWeaponAction;
+
+	UWeaponInventoryComponent();
+
+	/** Attaches the weapon to the owner and equips it, fails if a weapon of the same class is already owned */
+	bool AddWeapon(UPhysicsWeaponComponent* Weapon);
+
+	/** Spawns a weapon pickup actor and adds its weapon, the pickup sphere is disabled */
+	UPhysicsWeaponComponent* AddWeaponFromClass(TSubclassOf<AActor> PickUpClass);
+
+	/** Called by weapons leaving play */
+	void RemoveWeapon(UPhysicsWeaponComponent* Weapon);
+
+	UFUNCTION(BlueprintCallable, Category = Inventory)
+	bool EquipWeapon(int32 Index);
+
+	UFUNCTION(BlueprintCallable, Category = Inventory)
+	void NextWeapon();
+
+	UFUNCTION(BlueprintCallable, Category = Inventory)
+	void PreviousWeapon();
+
+	/** Fires one shot of the active weapon right now, outside of its fire schedule */
+	UFUNCTION(BlueprintCallable, Category = Inventory)
+	void Fire();
+
+	/** Holds or releases the trigger of the active weapon, a press starts the latency correlation of the shots it fires */
+	UFUNCTION(BlueprintCallable, Category = Inventory)
+	void SetTriggerHeld(bool bHeld);
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	UFUNCTION(BlueprintCallable, Category = Inventory)
+	UPhysicsWeaponComponent* GetActiveWeapon() const { return m_Weapons.IsValidIndex(m_ActiveIndex) ? m_Weapons[m_ActiveIndex] : nullptr; }
+
+	int32 GetNumWeapons() const { return m_Weapons.Num(); }
+
+	/** Binds the actions and mapping contexts of the owned weapons that are not bound yet, called when the controller changes */
+	void BindInput();
+
+	/** Swap timings, read by the soak test */
+	int32 GetSwapCount() const { return m_SwapCount; }
+	double GetSwapTimeTotalUs() const { return m_SwapTimeTotalUs; }
+	double GetSwapTimeMaxUs() const { return m_SwapTimeMaxUs; }
+
+	/** Shots fired by all the owned weapons */
+	int32 GetShotCount() const;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	void SetWeaponActive(UPhysicsWeaponComponent* Weapon, bool bActive) const;
+
+	void RemoveMappingContexts();
+
+	void PressTrigger() { SetTriggerHeld(true); }
+	void ReleaseTrigger() { SetTriggerHeld(false); }
+
+	APhysicsCharacter* GetCharacter() const;
+
+	UPROPERTY()
+	TArray<UPhysicsWeaponComponent*> m_Weapons;
+
+	int32 m_ActiveIndex = INDEX_NONE;
+
+	bool m_bTriggerHeld = false;
+
+	/** Set by a swap while the trigger is held, the new weapon sees a released trigger until it really is released */
+	bool m_bWaitForRelease = false;
+
+	/** Latency correlation of the last trigger edge, current for the first batch of shots fired after it */
+	uint32 m_TriggerLatencyId = 0;
+
+	/** Controller the current bindings were made on, everything is bound again when it changes */
+	TWeakObjectPtr<APlayerController> m_BoundController;
+
+	UPROPERTY()
+	TArray<UInputAction*> m_BoundActions;
+
+	UPROPERTY()
+	TArray<UInputMappingContext*> m_AddedContexts;
+
+	int32 m_SwapCount = 0;
+	double m_SwapTimeTotalUs = 0.0;
+	double m_SwapTimeMaxUs = 0.0;
+};
@@ -0,0 +1,166 @@
+// Times the structure-of-arrays batch variants of the gameplay math against a loop over their scalar version.
+// Usage: GameplayMathBenchmark [Count] [Repeats]
+
+#include "Core/GameplayMath.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace PhysicsCore;
+
+namespace
+{
+	/** Consumed results, printed at the end so the compiler cannot drop the timed loops */
+	double Sink = 0.0;
+
+	template <typename FunctionType>
+	double TimeNanosecondsPerItem(int32_t Count, int32_t Repeats, FunctionType&& Function)
+	{
+		// One untimed pass to warm the caches
+		Function();
+		const auto Start = std::chrono::steady_clock::now();
+		for (int32_t r = 0; r < Repeats; ++r)
+		{
+			Function();
+		}
+		const std::chrono::duration<double, std::nano> Elapsed = std::chrono::steady_clock::now() - Start;
+		return Elapsed.count() / (static_cast<double>(Count) * static_cast<double>(Repeats));
+	}
+
+	void Report(const char* Name, double ScalarNs, double BatchNs)
+	{
+		std::printf("%-24s scalar %7.3f ns  batch %7.3f ns  speedup %5.2fx\n", Name, ScalarNs, BatchNs, ScalarNs / BatchNs);
+	}
+}
+
+int main(int ArgCount, char** Args)
+{
+	const int32_t Count = ArgCount > 1 ? std::atoi(Args[1]) : 4096;
+	const int32_t Repeats = ArgCount > 2 ? std::atoi(Args[2]) : 2000;
+	if (Count <= 0 || Repeats <= 0)
+	{
+		std::printf("Usage: GameplayMathBenchmark [Count] [Repeats]\n");
+		return 1;
+	}
+
+	const size_t Size = static_cast<size_t>(Count);
+	std::mt19937 Random(1);
+	std::uniform_real_distribution<float> Coordinate(-5000.f, 5000.f);
+	std::uniform_real_distribution<float> Angle(-180.f, 180.f);
+	std::uniform_real_distribution<float> Speed(0.f, 1200.f);
+
+	std::vector<float> X(Size), Y(Size), Z(Size), OutX(Size), OutY(Size), OutZ(Size);
+	std::vector<Rotator> Aims(Size);
+	for (size_t i = 0; i < Size; ++i)
+	{
+		X[i] = Coordinate(Random);
+		Y[i] = Coordinate(Random);
+		Z[i] = Coordinate(Random);
+		Aims[i] = Rotator{ Angle(Random) * 0.5f, Angle(Random), 0.f };
+	}
+
+	std::printf("%d items, %d repeats\n", Count, Repeats);
+
+	{
+		StaminaParams Params;
+		Params.Max = 100.f;
+		Params.DepletionRate = 10.f;
+		Params.RecoveryRate = 5.f;
+		Params.WalkSpeed = 600.f;
+		std::vector<float> Speeds(Size), Current(Size, 50.f);
+		std::vector<uint8_t> Block(Size, 0);
+		std::vector<StaminaState> States(Size, StaminaState{ 50.f, false });
+		for (float& Value : Speeds)
+		{
+			Value = Speed(Random);
+		}
+
+		const double ScalarNs = TimeNanosecondsPerItem(Count, Repeats, [&]
+		{
+			for (size_t i = 0; i < Size; ++i)
+			{
+				States[i] = StepStamina(States[i], Params, Speeds[i], 1.f / 60.f);
+			}
+		});
+		const double BatchNs = TimeNanosecondsPerItem(Count, Repeats, [&] { StepStaminaBatch(Current.data(), Block.data(), Speeds.data(), Count, Params, 1.f / 60.f); });
+		Sink += static_cast<double>(States[Size / 2].Current + Current[Size / 2]);
+		Report("StepStamina", ScalarNs, BatchNs);
+	}
+
+	{
+		std::vector<float> Velocity(Size, 0.f);
+		std::vector<Vec3> Velocities(Size);
+		const double ScalarNs = TimeNanosecondsPerItem(Count, Repeats, [&]
+		{
+			for (size_t i = 0; i < Size; ++i)
+			{
+				Velocities[i] = SpringDamperVelocity(Vec3(X[i], 0.f, 0.f), Velocities[i], Vec3(Y[i], 0.f, 0.f), 0.02f, 0.2f);
+			}
+		});
+		const double BatchNs = TimeNanosecondsPerItem(Count, Repeats, [&] { SpringDamperBatch(Velocity.data(), X.data(), Y.data(), Count, 0.02f, 0.2f); });
+		Sink += static_cast<double>(Velocities[Size / 2].X + Velocity[Size / 2]);
+		Report("SpringDamper (1 axis)", ScalarNs, BatchNs);
+	}
+
+	{
+		const Vec3 Offset(100.f, 20.f, -10.f);
+		std::vector<Vec3> Muzzles(Size);
+		const double ScalarNs = TimeNanosecondsPerItem(Count, Repeats, [&]
+		{
+			for (size_t i = 0; i < Size; ++i)
+			{
+				Muzzles[i] = MuzzleLocation(Vec3(X[i], Y[i], Z[i]), Aims[i], Offset);
+			}
+		});
+		const double BatchNs = TimeNanosecondsPerItem(Count, Repeats, [&]
+		{
+			OutX = X;
+			OutY = Y;
+			OutZ = Z;
+			MuzzleLocationBatch(OutX.data(), OutY.data(), OutZ.data(), Aims.data(), Count, Offset);
+		});
+		Sink += static_cast<double>(Muzzles[Size / 2].X + OutX[Size / 2]);
+		Report("MuzzleLocation", ScalarNs, BatchNs);
+	}
+
+	{
+		const Vec3 Start(0.f, 0.f, 100.f);
+		const Vec3 Velocity(2000.f, 300.f, 800.f);
+		const Vec3 Gravity(0.f, 0.f, -980.f);
+		std::vector<Vec3> Positions(Size);
+		const double ScalarNs = TimeNanosecondsPerItem(Count, Repeats, [&]
+		{
+			for (size_t i = 0; i < Size; ++i)
+			{
+				Positions[i] = BallisticPosition(Start, Velocity, Gravity, static_cast<float>(i) * 0.01f);
+			}
+		});
+		const double BatchNs = TimeNanosecondsPerItem(Count, Repeats, [&] { BallisticPositionsBatch(OutX.data(), OutY.data(), OutZ.data(), Count, Start, Velocity, Gravity, 0.01f); });
+		Sink += static_cast<double>(Positions[Size / 2].Z + OutZ[Size / 2]);
+		Report("BallisticPositions", ScalarNs, BatchNs);
+	}
+
+	{
+		// Perspective like matrix, W grows with X so about half the points are behind the camera
+		Matrix44 ViewProjection = {};
+		ViewProjection.M[1][0] = 1.f;
+		ViewProjection.M[2][1] = 1.f;
+		ViewProjection.M[0][3] = 1.f;
+		std::vector<float> W(Size), DirX(Size), DirY(Size);
+		std::vector<uint8_t> OnScreen(Size);
+		const double BatchNs = TimeNanosecondsPerItem(Count, Repeats, [&]
+		{
+			ProjectPointsBatch(OutX.data(), OutY.data(), W.data(), X.data(), Y.data(), Z.data(), Count, ViewProjection, 1920.f, 1080.f);
+			ClampToScreenEdgeBatch(OutX.data(), OutY.data(), DirX.data(), DirY.data(), OnScreen.data(), W.data(), Count, 1920.f, 1080.f, 40.f);
+			DistanceBatch(OutZ.data(), X.data(), Y.data(), Z.data(), Count, Vec3());
+		});
+		Sink += static_cast<double>(OutX[Size / 2] + DirY[Size / 2] + OutZ[Size / 2]);
+		std::printf("%-24s batch %7.3f ns\n", "Screen indicators", BatchNs);
+	}
+
+	std::printf("checksum %g\n", Sink);
+	return 0;
+}
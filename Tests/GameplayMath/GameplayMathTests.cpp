@@ -0,0 +1,263 @@
+// Unit tests of the engine independent gameplay math, see CMakeLists.txt in this folder.
+// Each batch variant is checked against its scalar version, which is the one checked against known values.
+
+#include "Core/GameplayMath.h"
+
+#include <cmath>
+#include <cstdio>
+
+using namespace PhysicsCore;
+
+namespace
+{
+	int NumFailures = 0;
+
+	void Check(bool bCondition, const char* Expression, const char* File, int Line)
+	{
+		if (!bCondition)
+		{
+			std::printf("%s:%d: check failed: %s\n", File, Line, Expression);
+			++NumFailures;
+		}
+	}
+
+	bool NearlyEqual(double A, double B, double Tolerance = 1e-3)
+	{
+		return std::fabs(A - B) <= Tolerance * std::fmax(1.0, std::fmax(std::fabs(A), std::fabs(B)));
+	}
+
+	bool NearlyEqual(const Vec3& A, const Vec3& B, double Tolerance = 1e-3)
+	{
+		return NearlyEqual(A.X, B.X, Tolerance) && NearlyEqual(A.Y, B.Y, Tolerance) && NearlyEqual(A.Z, B.Z, Tolerance);
+	}
+}
+
+#define CHECK(Expression) Check(static_cast<bool>(Expression), #Expression, __FILE__, __LINE__)
+
+static void TestBallistics()
+{
+	const Vec3 Start(0.f, 0.f, 0.f);
+	const Vec3 Velocity(100.f, 0.f, 100.f);
+	const Vec3 Gravity(0.f, 0.f, -980.f);
+
+	CHECK(NearlyEqual(BallisticPosition(Start, Velocity, Gravity, 1.f), Vec3(100.f, 0.f, -390.f)));
+	CHECK(NearlyEqual(BallisticVelocity(Velocity, Gravity, 1.f), Vec3(100.f, 0.f, -880.f)));
+	CHECK(NearlyEqual(BallisticPosition(Start, Velocity, Gravity, 0.f), Start));
+
+	constexpr int32_t Count = 37;
+	float X[Count], Y[Count], Z[Count];
+	BallisticPositionsBatch(X, Y, Z, Count, Start, Velocity, Gravity, 0.05f);
+	for (int32_t i = 0; i < Count; ++i)
+	{
+		CHECK(NearlyEqual(Vec3(X[i], Y[i], Z[i]), BallisticPosition(Start, Velocity, Gravity, static_cast<float>(i) * 0.05f)));
+	}
+
+	// Normal part reflected and scaled by the bounciness, tangent part slowed by the friction
+	CHECK(NearlyEqual(BounceVelocity(Vec3(100.f, 0.f, -100.f), Vec3(0.f, 0.f, 1.f), 0.5f, 0.2f), Vec3(80.f, 0.f, 50.f)));
+	CHECK(NearlyEqual(BounceVelocity(Vec3(100.f, 0.f, -100.f), Vec3(0.f, 0.f, 1.f), 0.5f, 2.f), Vec3(0.f, 0.f, 50.f)));
+}
+
+static void TestStamina()
+{
+	StaminaParams Params;
+	Params.Max = 100.f;
+	Params.DepletionRate = 10.f;
+	Params.RecoveryRate = 5.f;
+	Params.WalkSpeed = 600.f;
+
+	StaminaState State{ 50.f, false };
+	CHECK(NearlyEqual(StepStamina(State, Params, 700.f, 0.1f).Current, 49.f));
+	CHECK(NearlyEqual(StepStamina(State, Params, 600.f, 0.1f).Current, 50.5f));
+	CHECK(NearlyEqual(StepStamina(StaminaState{ 99.9f, false }, Params, 0.f, 1.f).Current, 100.f));
+
+	// Running dry blocks sprinting, and walking keeps it blocked while stamina recovers
+	State = StepStamina(StaminaState{ 0.5f, false }, Params, 700.f, 1.f);
+	CHECK(State.Current == 0.f);
+	CHECK(State.bBlockSprint);
+	State = StepStamina(State, Params, 0.f, 1.f);
+	CHECK(NearlyEqual(State.Current, 5.f));
+	CHECK(State.bBlockSprint);
+
+	constexpr int32_t Count = 8;
+	const float Speeds[Count] = { 0.f, 700.f, 650.f, 700.f, 1000.f, 0.f, 700.f, 661.f };
+	float Current[Count] = { 50.f, 50.f, 50.f, 0.5f, 1.f, 99.9f, 100.f, 0.f };
+	uint8_t Block[Count] = { 0, 0, 1, 0, 0, 1, 0, 0 };
+	StaminaState Expected[Count];
+	for (int32_t i = 0; i < Count; ++i)
+	{
+		Expected[i] = StepStamina(StaminaState{ Current[i], Block[i] != 0 }, Params, Speeds[i], 0.25f);
+	}
+	StepStaminaBatch(Current, Block, Speeds, Count, Params, 0.25f);
+	for (int32_t i = 0; i < Count; ++i)
+	{
+		CHECK(NearlyEqual(Current[i], Expected[i].Current));
+		CHECK((Block[i] != 0) == Expected[i].bBlockSprint);
+	}
+}
+
+static void TestDamage()
+{
+	CHECK(NearlyEqual(RayDamageDirection(Vec3(0.f, 0.f, 1.f)), Vec3(0.f, 0.f, -1.f)));
+	CHECK(NearlyEqual(RayDamageDirection(Vec3(1.f, 0.f, 0.f)), Vec3(-1.f, 0.f, 0.f)));
+}
+
+static void TestGrabAndSpring()
+{
+	CHECK(NearlyEqual(GrabOffset(Vec3(0.f, 1.f, 0.f), 200.f), Vec3(0.f, 200.f, 0.f)));
+
+	CHECK(NearlyEqual(SpringDamperVelocity(Vec3(), Vec3(), Vec3(10.f, 0.f, 0.f), 0.5f, 0.1f), Vec3(5.f, 0.f, 0.f)));
+	CHECK(NearlyEqual(SpringDamperVelocity(Vec3(), Vec3(10.f, 0.f, 0.f), Vec3(), 0.f, 0.1f), Vec3(9.f, 0.f, 0.f)));
+
+	// A damped spring settles on its target
+	const float Dt = 1.f / 60.f;
+	Vec3 Position;
+	Vec3 Velocity;
+	const Vec3 Target(100.f, -50.f, 20.f);
+	for (int i = 0; i < 600; ++i)
+	{
+		Velocity = SpringDamperVelocity(Position, Velocity, Target, 80.f * Dt, 14.f * Dt);
+		Position = Position + Velocity * Dt;
+	}
+	CHECK(NearlyEqual(Position, Target, 1e-2));
+
+	constexpr int32_t Count = 5;
+	float Velocities[Count] = { 0.f, 10.f, -5.f, 100.f, 3.f };
+	const float Positions[Count] = { 0.f, 5.f, -20.f, 50.f, 3.f };
+	const float Targets[Count] = { 10.f, 5.f, 20.f, -50.f, 3.f };
+	float Expected[Count];
+	for (int32_t i = 0; i < Count; ++i)
+	{
+		Expected[i] = SpringDamperVelocity(Vec3(Positions[i], 0.f, 0.f), Vec3(Velocities[i], 0.f, 0.f), Vec3(Targets[i], 0.f, 0.f), 0.3f, 0.2f).X;
+	}
+	SpringDamperBatch(Velocities, Positions, Targets, Count, 0.3f, 0.2f);
+	for (int32_t i = 0; i < Count; ++i)
+	{
+		CHECK(NearlyEqual(Velocities[i], Expected[i]));
+	}
+}
+
+static void TestMuzzle()
+{
+	const Vec3 Offset(100.f, 0.f, 10.f);
+	CHECK(NearlyEqual(MuzzleLocation(Vec3(), Rotator{ 0.f, 90.f, 0.f }, Offset), Vec3(0.f, 100.f, 10.f), 1e-4));
+	CHECK(NearlyEqual(MuzzleLocation(Vec3(1.f, 2.f, 3.f), Rotator{ 90.f, 0.f, 0.f }, Offset), Vec3(-9.f, 2.f, 103.f), 1e-4));
+
+	const Rotator Aims[3] = { { 0.f, 0.f, 0.f }, { 10.f, 45.f, 0.f }, { -30.f, 200.f, 15.f } };
+	float X[3] = { 0.f, 100.f, -5.f };
+	float Y[3] = { 0.f, 50.f, 7.f };
+	float Z[3] = { 0.f, 0.f, 300.f };
+	Vec3 Expected[3];
+	for (int32_t i = 0; i < 3; ++i)
+	{
+		Expected[i] = MuzzleLocation(Vec3(X[i], Y[i], Z[i]), Aims[i], Offset);
+	}
+	MuzzleLocationBatch(X, Y, Z, Aims, 3, Offset);
+	for (int32_t i = 0; i < 3; ++i)
+	{
+		CHECK(NearlyEqual(Vec3(X[i], Y[i], Z[i]), Expected[i]));
+	}
+}
+
+static void TestProjection()
+{
+	// Clip X and Y are the world X and Y, clip W is the world Z: points with Z > 0 are in front of the camera
+	Matrix44 ViewProjection = {};
+	ViewProjection.M[0][0] = 1.f;
+	ViewProjection.M[1][1] = 1.f;
+	ViewProjection.M[2][3] = 1.f;
+
+	constexpr int32_t Count = 4;
+	const float X[Count] = { 0.f, 0.5f, 4.f, 0.5f };
+	const float Y[Count] = { 0.f, 0.5f, 0.f, 0.f };
+	const float Z[Count] = { 1.f, 1.f, 1.f, -1.f };
+	float ScreenX[Count], ScreenY[Count], W[Count];
+	ProjectPointsBatch(ScreenX, ScreenY, W, X, Y, Z, Count, ViewProjection, 200.f, 100.f);
+
+	CHECK(NearlyEqual(ScreenX[0], 100.f) && NearlyEqual(ScreenY[0], 50.f));
+	CHECK(NearlyEqual(ScreenX[1], 150.f) && NearlyEqual(ScreenY[1], 25.f));
+	CHECK(NearlyEqual(ScreenX[2], 500.f));
+	CHECK(NearlyEqual(ScreenX[3], 50.f) && W[3] < 0.f);
+
+	float DirX[Count], DirY[Count];
+	uint8_t OnScreen[Count];
+	ClampToScreenEdgeBatch(ScreenX, ScreenY, DirX, DirY, OnScreen, W, Count, 200.f, 100.f, 10.f);
+
+	// Inside points keep their position, the others land on the border shrunk by the margin
+	CHECK(OnScreen[1] == 1 && NearlyEqual(ScreenX[1], 150.f) && NearlyEqual(ScreenY[1], 25.f));
+	CHECK(NearlyEqual(DirX[1] * DirX[1] + DirY[1] * DirY[1], 1.f));
+	CHECK(OnScreen[2] == 0 && NearlyEqual(ScreenX[2], 190.f) && NearlyEqual(ScreenY[2], 50.f));
+	CHECK(NearlyEqual(DirX[2], 1.f) && NearlyEqual(DirY[2], 0.f));
+
+	// Behind the camera the mirrored pixel is flipped back, so the indicator points to the side to turn to
+	CHECK(OnScreen[3] == 0 && NearlyEqual(ScreenX[3], 190.f) && NearlyEqual(DirX[3], 1.f));
+
+	const float PX[2] = { 3.f, 0.f };
+	const float PY[2] = { 4.f, 0.f };
+	const float PZ[2] = { 0.f, -2.f };
+	float Distances[2];
+	DistanceBatch(Distances, PX, PY, PZ, 2, Vec3());
+	CHECK(NearlyEqual(Distances[0], 5.f) && NearlyEqual(Distances[1], 2.f));
+}
+
+static void TestScheduleShots()
+{
+	double Shots[8];
+
+	FireParams Auto;
+	Auto.Mode = FireMode::Auto;
+	Auto.Interval = 0.125;
+	FireState State;
+	CHECK(ScheduleShots(State, Auto, true, 1.0, Shots, 8) == 1 && Shots[0] == 1.0);
+	CHECK(ScheduleShots(State, Auto, true, 1.3, Shots, 8) == 2 && Shots[0] == 1.125 && Shots[1] == 1.25);
+
+	// A press right after a release still waits for the interval of the last shot
+	CHECK(ScheduleShots(State, Auto, false, 1.31, Shots, 8) == 0);
+	CHECK(ScheduleShots(State, Auto, true, 1.33, Shots, 8) == 0);
+	CHECK(ScheduleShots(State, Auto, true, 1.375, Shots, 8) == 1 && Shots[0] == 1.375);
+
+	// A long frame fires at most MaxShots and resumes from now instead of queuing the rest
+	CHECK(ScheduleShots(State, Auto, true, 20.0, Shots, 4) == 4 && Shots[3] == 1.875);
+	CHECK(State.NextShotTime == 20.0);
+
+	FireParams Burst;
+	Burst.Mode = FireMode::Burst;
+	Burst.Interval = 0.1;
+	Burst.BurstCount = 3;
+	Burst.BurstCooldown = 0.3;
+	State = FireState();
+	CHECK(ScheduleShots(State, Burst, true, 0.0, Shots, 8) == 1);
+	CHECK(ScheduleShots(State, Burst, false, 1.0, Shots, 8) == 2 && NearlyEqual(Shots[1], 0.2, 1e-9));
+	CHECK(NearlyEqual(State.NextShotTime, 0.6, 1e-9));
+	CHECK(ScheduleShots(State, Burst, true, 1.5, Shots, 8) == 1 && Shots[0] == 1.5);
+	CHECK(State.BurstRemaining == 2);
+
+	FireParams Charge;
+	Charge.Mode = FireMode::Charge;
+	Charge.Interval = 0.1;
+	Charge.ChargeTime = 0.5;
+	State = FireState();
+	CHECK(ScheduleShots(State, Charge, true, 0.0, Shots, 8) == 0);
+	CHECK(ScheduleShots(State, Charge, false, 0.3, Shots, 8) == 0);
+	CHECK(ScheduleShots(State, Charge, true, 1.0, Shots, 8) == 0);
+	CHECK(ScheduleShots(State, Charge, true, 1.4, Shots, 8) == 0);
+	CHECK(ScheduleShots(State, Charge, false, 1.6, Shots, 8) == 1 && Shots[0] == 1.6);
+}
+
+int main()
+{
+	TestBallistics();
+	TestStamina();
+	TestDamage();
+	TestGrabAndSpring();
+	TestMuzzle();
+	TestProjection();
+	TestScheduleShots();
+
+	if (NumFailures > 0)
+	{
+		std::printf("%d check(s) failed\n", NumFailures);
+		return 1;
+	}
+	std::printf("All gameplay math checks passed\n");
+	return 0;
+}